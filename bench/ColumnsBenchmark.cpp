@@ -0,0 +1,200 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QTest>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "ReportModel.h"
+
+static constexpr int TypeCount = 64;
+
+// Previous layout: one struct per report
+struct report_row {
+	int id;
+	DF::time time;
+	QString text;
+	QByteArray type_name;
+	int type;
+	int color;
+	int repeat;
+};
+
+struct Reports {
+	std::vector<report_row> rows;
+	ReportModel::report_columns columns;
+	std::vector<char> enabled_types;
+};
+
+static Reports makeReports(int count)
+{
+	Reports reports;
+	auto &columns = reports.columns;
+	reports.rows.reserve(count);
+	for (int i = 0; i < count; ++i) {
+		// Reports from the same type and day come in bursts
+		int id = 2*i;
+		auto time = DF::time(DF::year(250)) + DF::tick(i / 4);
+		int type = (i / 8) % TypeCount;
+		int repeat = i % 7 == 0 ? i % 5 : 0;
+		auto text = QString("The Dwarf strikes The Goblin in the head with her iron battle axe! (%1)").arg(i);
+		auto type_name = QByteArray("TYPE_") + QByteArray::number(type);
+		reports.rows.push_back({id, time, text, type_name, type, 7, repeat});
+		columns.id.append(id);
+		columns.end_id.append(id);
+		columns.time.append(time);
+		columns.type.append(type);
+		columns.color.append(7);
+		columns.repeat.append(repeat);
+		columns.display.append(ReportModel::displayText(text, repeat));
+		columns.text.append(std::move(text));
+		columns.index_entries.append(0);
+	}
+	reports.enabled_types.resize(TypeCount);
+	for (int t = 0; t < TypeCount; ++t)
+		reports.enabled_types[t] = t % 3 != 0;
+	return reports;
+}
+
+// Scans run by the filters and the diff over the struct (rows) and
+// columnar (columns) layouts of the reports.
+class ColumnsBenchmark: public QObject
+{
+	Q_OBJECT
+private slots:
+	void cleanupTestCase();
+
+	void typeFilter_data() { addData(); }
+	void typeFilter();
+	void dateRange_data() { addData(); }
+	void dateRange();
+	void idMerge_data() { addData(); }
+	void idMerge();
+
+private:
+	void addData();
+	const Reports &reports(int count);
+
+	std::map<int, Reports> _reports;
+};
+
+void ColumnsBenchmark::cleanupTestCase()
+{
+	_reports.clear();
+}
+
+void ColumnsBenchmark::addData()
+{
+	QTest::addColumn<int>("count");
+	QTest::addColumn<bool>("columnar");
+	for (int count: {100'000, 1'000'000}) {
+		QTest::addRow("%d rows, struct", count) << count << false;
+		QTest::addRow("%d rows, columns", count) << count << true;
+	}
+}
+
+const Reports &ColumnsBenchmark::reports(int count)
+{
+	auto it = _reports.find(count);
+	if (it == _reports.end())
+		it = _reports.emplace(count, makeReports(count)).first;
+	return it->second;
+}
+
+void ColumnsBenchmark::typeFilter()
+{
+	QFETCH(int, count);
+	QFETCH(bool, columnar);
+	const auto &r = reports(count);
+	const auto &enabled = r.enabled_types;
+	// Enabled types with a query like "repeat>1"
+	int accepted = 0;
+	if (columnar) {
+		QBENCHMARK {
+			accepted = 0;
+			for (int row = 0; row < r.columns.size(); ++row)
+				accepted += enabled[r.columns.type[row]] && r.columns.repeat[row] > 1;
+		}
+	}
+	else {
+		QBENCHMARK {
+			accepted = 0;
+			for (const auto &report: r.rows)
+				accepted += enabled[report.type] && report.repeat > 1;
+		}
+	}
+	QVERIFY(accepted > 0);
+}
+
+void ColumnsBenchmark::dateRange()
+{
+	QFETCH(int, count);
+	QFETCH(bool, columnar);
+	const auto &r = reports(count);
+	auto begin = DF::time(DF::year(250)) + DF::tick(count / 16);
+	auto end = begin + DF::tick(count / 8);
+	int accepted = 0;
+	if (columnar) {
+		QBENCHMARK {
+			accepted = std::ranges::count_if(r.columns.time, [&](DF::time t) {
+					return t >= begin && t < end;
+				});
+		}
+	}
+	else {
+		QBENCHMARK {
+			accepted = std::ranges::count_if(r.rows, [&](const report_row &report) {
+					return report.time >= begin && report.time < end;
+				});
+		}
+	}
+	QVERIFY(accepted > 0);
+}
+
+void ColumnsBenchmark::idMerge()
+{
+	QFETCH(int, count);
+	QFETCH(bool, columnar);
+	const auto &r = reports(count);
+	// The general merge compares the model ids with the received ones
+	std::vector<int> ids(count);
+	for (int i = 0; i < count; ++i)
+		ids[i] = 2*i;
+	ids.back() += 1;
+	qsizetype matched = 0;
+	if (columnar) {
+		QBENCHMARK {
+			auto [a, b] = std::mismatch(r.columns.id.begin(), r.columns.id.end(), ids.begin(), ids.end());
+			matched = std::distance(r.columns.id.begin(), a);
+		}
+	}
+	else {
+		QBENCHMARK {
+			auto [a, b] = std::mismatch(r.rows.begin(), r.rows.end(), ids.begin(), ids.end(),
+					[](const report_row &report, int id) { return report.id == id; });
+			matched = std::distance(r.rows.begin(), a);
+		}
+	}
+	QCOMPARE(matched, qsizetype(count - 1));
+}
+
+QTEST_APPLESS_MAIN(ColumnsBenchmark)
+
+#include "ColumnsBenchmark.moc"
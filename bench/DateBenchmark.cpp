@@ -0,0 +1,143 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QStandardPaths>
+#include <QTest>
+
+#include <algorithm>
+#include <vector>
+
+#include "Application.h"
+#include "ReportModel.h"
+
+static constexpr int ReportCount = 100'000;
+// Reports happen in bursts, about this many on each day
+static constexpr int ReportsPerDay = 20;
+// Rows painted by the view for each scroll step
+static constexpr int VisibleRows = 50;
+
+static DF::time reportTime(int i)
+{
+	return DF::time(DF::year(250)) + DF::tick(i * 1200 / ReportsPerDay);
+}
+
+// Formatter used before the cache, with the QString::arg chain
+static QString argPrettyDate(DF::time duration)
+{
+	auto d = DF::date<DF::year, DF::month, DF::day>(duration);
+	return QString("%1%2 %3 %4")
+		.arg(std::get<2>(d).count()+1)
+		.arg(DF::daySuffix(std::get<2>(d).count()+1))
+		.arg(DF::Months[std::get<1>(d).count()])
+		.arg(std::get<0>(d).count());
+}
+
+// Formatting the Date column of the visible rows while scrolling through
+// the whole history.
+class DateBenchmark: public QObject
+{
+	Q_OBJECT
+private slots:
+	void initTestCase();
+
+	void formatter_data();
+	void formatter();
+	void modelData();
+
+private:
+	std::vector<DF::time> _times;
+	ReportModel _model;
+};
+
+void DateBenchmark::initTestCase()
+{
+	for (int i = 0; i < ReportCount; ++i)
+		_times.push_back(reportTime(i));
+	dfproto::Reports::ReportList list;
+	for (int i = 0; i < ReportCount; ++i) {
+		auto report = list.add_reports();
+		report->set_id(i);
+		report->set_type("COMBAT");
+		report->set_text("The Dwarf strikes The Goblin in the head with her iron battle axe!");
+		report->set_year(250);
+		report->set_time(i * 1200 / ReportsPerDay);
+	}
+	QVERIFY(_model.apply(ReportModel::diff(_model.snapshot(), list)));
+	QCOMPARE(_model.rowCount({}), ReportCount);
+}
+
+void DateBenchmark::formatter_data()
+{
+	QTest::addColumn<int>("formatter");
+	QTest::newRow("arg chain") << 0;
+	QTest::newRow("append") << 1;
+	QTest::newRow("day cache") << 2;
+}
+
+void DateBenchmark::formatter()
+{
+	QFETCH(int, formatter);
+	DF::PrettyDateCache cache;
+	qsizetype length = 0;
+	QBENCHMARK {
+		length = 0;
+		for (int first = 0; first < ReportCount; first += VisibleRows) {
+			for (int row = first; row < std::min(first + VisibleRows, ReportCount); ++row) {
+				switch (formatter) {
+				case 0:
+					length += argPrettyDate(_times[row]).size();
+					break;
+				case 1:
+					length += DF::prettyDate(_times[row]).size();
+					break;
+				case 2:
+					length += cache(_times[row]).size();
+					break;
+				}
+			}
+		}
+	}
+	QVERIFY(length > 0);
+}
+
+void DateBenchmark::modelData()
+{
+	// ReportModel::data as called by the view when painting
+	int column = static_cast<int>(ReportModel::Columns::Date);
+	qsizetype length = 0;
+	QBENCHMARK {
+		length = 0;
+		for (int first = 0; first < ReportCount; first += VisibleRows)
+			for (int row = first; row < std::min(first + VisibleRows, ReportCount); ++row)
+				length += _model.index(row, column).data().toString().size();
+	}
+	QVERIFY(length > 0);
+}
+
+int main(int argc, char *argv[])
+{
+	// ReportModel needs the application settings, the user settings are
+	// not read nor written. Run with QT_QPA_PLATFORM=offscreen without a
+	// display.
+	QStandardPaths::setTestModeEnabled(true);
+	Application app(argc, argv);
+	DateBenchmark benchmark;
+	return QTest::qExec(&benchmark, argc, argv);
+}
+
+#include "DateBenchmark.moc"
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QTest>
+
+#include <limits>
+
+#include "ReportModel.h"
+
+// Reports in the game buffer, sent by each full update
+static constexpr int BufferSize = 3000;
+// Reports added since the previous update
+static constexpr int NewReports = 10;
+
+static dfproto::Reports::ReportList makeReportList(int first_id, int count)
+{
+	dfproto::Reports::ReportList list;
+	for (int id = first_id; id < first_id + count; ++id) {
+		auto report = list.add_reports();
+		report->set_id(id);
+		report->set_type("COMBAT");
+		report->set_text("The Dwarf strikes The Goblin in the head with her iron battle axe!");
+		report->set_year(250);
+		report->set_time(id);
+	}
+	return list;
+}
+
+static ReportModel::Snapshot makeSnapshot(int history, bool keep_removed)
+{
+	ReportModel::Snapshot snapshot = {
+		0, {}, {}, {},
+		{{"COMBAT", 0}},
+		std::numeric_limits<int>::min(),
+		keep_removed,
+	};
+	snapshot.ids.reserve(history);
+	for (int id = 0; id < history; ++id)
+		snapshot.ids.append(id);
+	snapshot.end_ids = snapshot.ids;
+	snapshot.repeats.fill(0, history);
+	return snapshot;
+}
+
+// Cost of computing the changes for one refresh with different history
+// sizes (rows kept in the model beyond the game buffer). Without
+// keep_removed, the rows older than the buffer are removed by the diff.
+class DiffBenchmark: public QObject
+{
+	Q_OBJECT
+private slots:
+	void fullUpdate_data();
+	void fullUpdate();
+	void partialUpdate_data();
+	void partialUpdate();
+	void emptyList_data();
+	void emptyList();
+};
+
+void DiffBenchmark::fullUpdate_data()
+{
+	QTest::addColumn<int>("history");
+	QTest::addColumn<bool>("keep_removed");
+	QTest::addColumn<bool>("append_only");
+	for (int history: {10'000, 100'000, 1'000'000}) {
+		for (bool keep_removed: {true, false}) {
+			const char *mode = keep_removed ? "kept" : "removed";
+			QTest::addRow("%d rows, %s, appended", history, mode) << history << keep_removed << true;
+			QTest::addRow("%d rows, %s, merged", history, mode) << history << keep_removed << false;
+		}
+	}
+}
+
+void DiffBenchmark::fullUpdate()
+{
+	QFETCH(int, history);
+	QFETCH(bool, keep_removed);
+	QFETCH(bool, append_only);
+	auto snapshot = makeSnapshot(history, keep_removed);
+	// The buffer ends with the new reports
+	auto list = makeReportList(history - BufferSize + NewReports, BufferSize);
+	// A report missing from the middle of the buffer does not match the
+	// appended shape, the whole history is merged.
+	if (!append_only)
+		list.mutable_reports()->DeleteSubrange(BufferSize / 2, 1);
+	QBENCHMARK {
+		auto changes = ReportModel::diff(snapshot, list);
+		QVERIFY(!changes.operations.empty());
+	}
+}
+
+void DiffBenchmark::partialUpdate_data()
+{
+	QTest::addColumn<int>("history");
+	QTest::addColumn<bool>("keep_removed");
+	for (int history: {10'000, 100'000, 1'000'000}) {
+		QTest::addRow("%d rows, kept", history) << history << true;
+		QTest::addRow("%d rows, removed", history) << history << false;
+	}
+}
+
+void DiffBenchmark::partialUpdate()
+{
+	QFETCH(int, history);
+	QFETCH(bool, keep_removed);
+	auto snapshot = makeSnapshot(history, keep_removed);
+	// Only the reports after the last known one are sent
+	auto list = makeReportList(history - 1, NewReports + 1);
+	QBENCHMARK {
+		auto changes = ReportModel::diff(snapshot, list, history - 1);
+		QVERIFY(!changes.operations.empty());
+	}
+}
+
+void DiffBenchmark::emptyList_data()
+{
+	QTest::addColumn<int>("history");
+	for (int history: {10'000, 100'000, 1'000'000})
+		QTest::addRow("%d rows", history) << history;
+}
+
+void DiffBenchmark::emptyList()
+{
+	QFETCH(int, history);
+	// A new world or a reload cleared the game buffer, the kept
+	// reports must stay
+	auto snapshot = makeSnapshot(history, true);
+	dfproto::Reports::ReportList list;
+	QBENCHMARK {
+		auto changes = ReportModel::diff(snapshot, list);
+		QVERIFY(changes.operations.empty());
+	}
+}
+
+QTEST_APPLESS_MAIN(DiffBenchmark)
+
+#include "DiffBenchmark.moc"
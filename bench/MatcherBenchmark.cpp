@@ -0,0 +1,131 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QRegularExpression>
+#include <QTest>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include "SubstringMatcher.h"
+
+static constexpr int ReportCount = 100'000;
+
+static std::vector<QString> makeTexts()
+{
+	static const char *templates[] = {
+		"The Dwarf strikes The Goblin in the head with her iron battle axe!",
+		"Urist McMiner has been found dead, drained of blood.",
+		"A section of the cavern has collapsed!",
+		"The Elf bites The Giant Cave Spider in the left front leg, tearing the muscle!",
+		"Kogan Ërithùdir has become a Legendary Miner.",
+		"Some migrants have arrived.",
+		"The weather has cleared.",
+	};
+	std::vector<QString> texts;
+	texts.reserve(ReportCount);
+	for (int i = 0; i < ReportCount; ++i)
+		texts.push_back(QString::fromUtf8(templates[i % std::size(templates)]));
+	// A rare word only found in a few reports
+	for (int i = 0; i < ReportCount; i += 10'000)
+		texts[i].append(" The werebeast attacks!");
+	return texts;
+}
+
+// Case-insensitive substring search over report texts, with the matcher
+// used for plain text queries and the regular expression used before.
+class MatcherBenchmark: public QObject
+{
+	Q_OBJECT
+private slots:
+	void initTestCase();
+
+	void matcher_data() { addData(); }
+	void matcher();
+	void regularExpression_data() { addData(); }
+	void regularExpression();
+	void stringView_data() { addData(); }
+	void stringView();
+
+private:
+	void addData();
+
+	std::vector<QString> _texts;
+};
+
+void MatcherBenchmark::initTestCase()
+{
+	_texts = makeTexts();
+}
+
+void MatcherBenchmark::addData()
+{
+	QTest::addColumn<QString>("needle");
+	QTest::newRow("common") << QString("goblin");
+	QTest::newRow("rare") << QString("WEREBEAST");
+	QTest::newRow("no match") << QString("forgotten beast");
+	QTest::newRow("non-ASCII") << QString("ërithùdir");
+}
+
+void MatcherBenchmark::matcher()
+{
+	QFETCH(QString, needle);
+	SubstringMatcher matcher(needle);
+	int count = 0;
+	QBENCHMARK {
+		count = 0;
+		for (const auto &text: _texts)
+			count += matcher.matches(text);
+	}
+	// Same results as QString::contains
+	QCOMPARE(count, int(std::ranges::count_if(_texts, [&needle](const QString &text) {
+			return text.contains(needle, Qt::CaseInsensitive);
+		})));
+}
+
+void MatcherBenchmark::regularExpression()
+{
+	QFETCH(QString, needle);
+	QRegularExpression re(QRegularExpression::escape(needle),
+			QRegularExpression::CaseInsensitiveOption);
+	re.optimize();
+	int count = 0;
+	QBENCHMARK {
+		count = 0;
+		for (const auto &text: _texts)
+			count += re.match(text).hasMatch();
+	}
+	Q_UNUSED(count);
+}
+
+void MatcherBenchmark::stringView()
+{
+	QFETCH(QString, needle);
+	int count = 0;
+	QBENCHMARK {
+		count = 0;
+		for (const auto &text: _texts)
+			count += QStringView(text).contains(needle, Qt::CaseInsensitive);
+	}
+	Q_UNUSED(count);
+}
+
+QTEST_APPLESS_MAIN(MatcherBenchmark)
+
+#include "MatcherBenchmark.moc"
@@ -37,8 +37,8 @@ AnnouncementTypeList::~AnnouncementTypeList()
 {
 	QSettings settings;
 	settings.beginGroup(AnnouncementTypeGroupName);
-	for (const auto &[name, enabled]: _types) {
-		settings.setValue(name, enabled);
+	for (std::size_t i = 0; i < _names.size(); ++i) {
+		settings.setValue(_names[i], bool(_enabled[i]));
 	}
 	settings.endGroup();
 }
@@ -53,17 +53,17 @@ int AnnouncementTypeList::rowCount(const QModelIndex &parent) const
 	if (parent.isValid())
 		return 0;
 	else
-		return _types.size();
+		return _rows.size();
 }
 
 QVariant AnnouncementTypeList::data(const QModelIndex &index, int role) const
 {
-	const auto &type = _types[index.row()];
+	int type_id = _rows[index.row()];
 	switch (role) {
 	case Qt::DisplayRole:
-		return type.first;
+		return _names[type_id];
 	case Qt::CheckStateRole:
-		return type.second ? Qt::Checked : Qt::Unchecked;
+		return _enabled[type_id] ? Qt::Checked : Qt::Unchecked;
 	default:
 		return {};
 	}
@@ -73,27 +73,44 @@ bool AnnouncementTypeList::setData(const QModelIndex &index, const QVariant &val
 {
 	if (role != Qt::CheckStateRole)
 		return false;
-	_types[index.row()].second = value.toBool();
-	dataChanged(index, index, {Qt::CheckStateRole});
-	typesChanged();
+	int type_id = _rows[index.row()];
+	bool enabled = value.toBool();
+	if (_enabled[type_id] != enabled) {
+		_enabled[type_id] = enabled;
+		dataChanged(index, index, {Qt::CheckStateRole});
+		typeEnabledChanged(type_id, enabled);
+	}
 	return true;
 }
 
-bool AnnouncementTypeList::isTypeEnabled(const QByteArray &type) const
+void AnnouncementTypeList::setTypesEnabled(const std::vector<int> &type_ids, bool enabled)
 {
-	auto it = std::ranges::lower_bound(_types, type, std::less<>{}, &decltype(_types)::value_type::first);
-	if (it == _types.end() || it->first != type)
-		return true;
-	return it->second;
+	bool changed = false;
+	for (int type_id: type_ids) {
+		if (_enabled[type_id] != enabled) {
+			_enabled[type_id] = enabled;
+			changed = true;
+		}
+	}
+	if (!changed)
+		return;
+	dataChanged(index(0), index(_rows.size()-1), {Qt::CheckStateRole});
+	typesChanged();
 }
 
-void AnnouncementTypeList::addType(const QByteArray &type, bool enabled)
+int AnnouncementTypeList::addType(const QByteArray &type, bool enabled)
 {
-	auto it = std::ranges::lower_bound(_types, type, std::less<>{}, &decltype(_types)::value_type::first);
-	if (it != _types.end() && it->first == type)
-		return;
-	int row = std::distance(_types.begin(), it);
+	auto id_it = _ids.find(type);
+	if (id_it != _ids.end())
+		return *id_it;
+	int type_id = _names.size();
+	auto it = std::ranges::lower_bound(_rows, type, std::less<>{}, [this](int id) -> const QByteArray & { return _names[id]; });
+	int row = std::distance(_rows.begin(), it);
 	beginInsertRows({}, row, row);
-	_types.insert(it, {type, enabled});
+	_names.push_back(type);
+	_enabled.push_back(enabled);
+	_ids.insert(type, type_id);
+	_rows.insert(it, type_id);
 	endInsertRows();
+	return type_id;
 }
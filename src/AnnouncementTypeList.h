@@ -20,6 +20,7 @@
 #define ANNOUNCEMENT_TYPE_LIST_H
 
 #include <QAbstractListModel>
+#include <QHash>
 
 class AnnouncementTypeList: public QAbstractListModel
 {
@@ -33,16 +34,32 @@ public:
 	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
 	bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
 
-	bool isTypeEnabled(const QByteArray &type) const;
+	// Types are interned: ids are indices in the order types were added
+	// and never change.
+	const QHash<QByteArray, int> &typeIds() const { return _ids; }
+	int typeId(const QByteArray &type) const { return _ids.value(type, -1); }
+	const QByteArray &typeName(int type_id) const { return _names[type_id]; }
+	bool isTypeEnabled(int type_id) const { return _enabled[type_id]; }
+	const std::vector<bool> &enabledTypes() const { return _enabled; }
+	// Type id displayed at row
+	int typeIdAt(int row) const { return _rows[row]; }
+	// Change several types at once, typesChanged is emitted only once
+	void setTypesEnabled(const std::vector<int> &type_ids, bool enabled);
 
 public slots:
-	void addType(const QByteArray &type, bool enabled = true);
+	int addType(const QByteArray &type, bool enabled = true);
 
 signals:
+	// A single type was checked or unchecked
+	void typeEnabledChanged(int type_id, bool enabled);
+	// Any number of types were checked or unchecked
 	void typesChanged();
 
 private:
-	std::vector<std::pair<QByteArray, bool>> _types;
+	std::vector<QByteArray> _names;
+	std::vector<bool> _enabled;
+	QHash<QByteArray, int> _ids;
+	std::vector<int> _rows; // type ids sorted by name
 };
 
 #endif
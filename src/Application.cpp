@@ -18,6 +18,8 @@
 
 #include "Application.h"
 
+#include <QEvent>
+
 Application::Application(int &argc, char **argv):
 	QApplication(argc, argv)
 {
@@ -31,3 +33,11 @@ Application::Application(int &argc, char **argv):
 Application::~Application()
 {
 }
+
+bool Application::event(QEvent *event)
+{
+	// Palette changes may also switch between light and dark themes
+	if (event->type() == QEvent::ApplicationPaletteChange && _settings)
+		_settings->color_palette.updateTheme();
+	return QApplication::event(event);
+}
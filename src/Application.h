@@ -35,6 +35,10 @@ public:
 	static Application *instance() {
 		return static_cast<Application *>(QCoreApplication::instance());
 	}
+
+protected:
+	bool event(QEvent *event) override;
+
 private:
 	std::unique_ptr<Settings> _settings;
 };
@@ -0,0 +1,202 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ArchiveModel.h"
+
+#include <algorithm>
+
+#include "Application.h"
+#include "ReportModel.h"
+
+// Number of reports indexed by each fetchMore call
+static constexpr int FetchSize = 10000;
+
+ArchiveModel::ArchiveModel(QObject *parent):
+	QAbstractTableModel(parent),
+	_at_end(true)
+{
+}
+
+ArchiveModel::~ArchiveModel()
+{
+}
+
+bool ArchiveModel::open(const QString &path)
+{
+	beginResetModel();
+	_offsets.clear();
+	_type_names.clear();
+	_type_slots.clear();
+	_types.clear();
+	_repeats.clear();
+	_data = {};
+	_reader = {};
+	_at_end = true;
+	_file.close();
+	_file.setFileName(path);
+	bool success = false;
+	if (_file.open(QIODevice::ReadOnly) && _file.size() > 0) {
+		if (auto data = _file.map(0, _file.size())) {
+			_data = QByteArrayView(data, _file.size());
+			_reader = ReportArchive::Reader(_data);
+			_at_end = !_reader.isValid();
+			success = _reader.isValid();
+		}
+	}
+	endResetModel();
+	return success;
+}
+
+int ArchiveModel::rowCount(const QModelIndex &parent) const
+{
+	if (parent.isValid())
+		return 0;
+	else
+		return _offsets.size();
+}
+
+int ArchiveModel::columnCount(const QModelIndex &) const
+{
+	return static_cast<int>(ReportModel::Columns::Count);
+}
+
+QVariant ArchiveModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+	if (orientation != Qt::Horizontal)
+		return {};
+	if (role != Qt::DisplayRole)
+		return {};
+	switch (static_cast<ReportModel::Columns>(section)) {
+	case ReportModel::Columns::Id:
+		return tr("Id");
+	case ReportModel::Columns::Date:
+		return tr("Date");
+	case ReportModel::Columns::Text:
+		return tr("Text");
+	case ReportModel::Columns::Type:
+		return tr("Type");
+	default:
+		return {};
+	}
+}
+
+QVariant ArchiveModel::data(const QModelIndex &index, int role) const
+{
+	auto settings = Application::instance()->settings();
+	int row = index.row();
+	// Only the requested row is decoded
+	ReportArchive::Reader report(_data);
+	report.seek(_offsets[row]);
+	if (!report.next())
+		return {};
+	switch (static_cast<ReportModel::Columns>(index.column())) {
+	case ReportModel::Columns::Id:
+		switch (role) {
+		case Qt::DisplayRole:
+			return report.id();
+		default:
+			return {};
+		}
+	case ReportModel::Columns::Date:
+		switch (role) {
+		case Qt::DisplayRole:
+			return _date_cache(report.time());
+		case ReportModel::SortRole:
+			return static_cast<qlonglong>(report.time().count());
+		default:
+			return {};
+		}
+	case ReportModel::Columns::Text:
+		switch (role) {
+		case Qt::DisplayRole:
+			return ReportModel::displayText(QString::fromUtf8(report.text()),
+					_repeats.value(report.id(), report.repeat()));
+		case Qt::ForegroundRole:
+			return settings->color_palette.brush(report.color());
+		default:
+			return {};
+		}
+	case ReportModel::Columns::Type:
+		switch (role) {
+		case Qt::DisplayRole:
+			return _type_names[_types[row]];
+		default:
+			return {};
+		}
+	default:
+		return {};
+	}
+}
+
+bool ArchiveModel::canFetchMore(const QModelIndex &parent) const
+{
+	return !parent.isValid() && !_at_end;
+}
+
+void ArchiveModel::fetchMore(const QModelIndex &parent)
+{
+	if (parent.isValid())
+		return;
+	std::vector<qsizetype> offsets;
+	std::vector<int> types;
+	std::vector<int> updated_ids; // repeat updates for already indexed rows
+	while (offsets.size() < FetchSize) {
+		if (!_reader.next()) {
+			_at_end = true;
+			break;
+		}
+		switch (_reader.type()) {
+		case ReportArchive::TypeRecord:
+			if (std::size_t(_reader.typeIndex()) >= _type_slots.size())
+				_type_slots.resize(_reader.typeIndex()+1, -1);
+			_type_slots[_reader.typeIndex()] = _type_names.size();
+			_type_names.push_back(_reader.typeName().toByteArray());
+			break;
+		case ReportArchive::ReportRecord:
+			if (std::size_t(_reader.typeIndex()) >= _type_slots.size() || _type_slots[_reader.typeIndex()] < 0)
+				continue; // unknown type, corrupted file
+			offsets.push_back(_reader.offset());
+			types.push_back(_type_slots[_reader.typeIndex()]);
+			break;
+		case ReportArchive::RepeatRecord:
+			_repeats.insert(_reader.id(), _reader.repeat());
+			updated_ids.push_back(_reader.id());
+			break;
+		case ReportArchive::SpanRecord:
+			break;
+		}
+	}
+	if (!offsets.empty()) {
+		int first = _offsets.size();
+		beginInsertRows({}, first, first + offsets.size() - 1);
+		_offsets.insert(_offsets.end(), offsets.begin(), offsets.end());
+		_types.insert(_types.end(), types.begin(), types.end());
+		endInsertRows();
+	}
+	// Report records are sorted by id, find updated rows with a binary search
+	int col = static_cast<int>(ReportModel::Columns::Text);
+	for (int id: updated_ids) {
+		auto it = std::ranges::lower_bound(_offsets, id, std::less<>{}, [this](qsizetype offset) {
+				return ReportArchive::Reader::recordId(_data, offset);
+			});
+		if (it != _offsets.end() && ReportArchive::Reader::recordId(_data, *it) == id) {
+			auto row = std::distance(_offsets.begin(), it);
+			dataChanged(index(row, col), index(row, col), {Qt::DisplayRole});
+		}
+	}
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ARCHIVE_MODEL_H
+#define ARCHIVE_MODEL_H
+
+#include <QAbstractTableModel>
+#include <QFile>
+#include <QHash>
+
+#include <vector>
+
+#include "ReportArchive.h"
+
+// Read-only view of a report archive. The file is mapped and only the
+// record offsets are kept in memory, rows are decoded when their data is
+// requested. The file is indexed progressively through fetchMore.
+class ArchiveModel: public QAbstractTableModel
+{
+	Q_OBJECT
+public:
+	ArchiveModel(QObject *parent = nullptr);
+	~ArchiveModel() override;
+
+	bool open(const QString &path);
+
+	int rowCount(const QModelIndex &parent) const override;
+	int columnCount(const QModelIndex &parent) const override;
+	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+	bool canFetchMore(const QModelIndex &parent) const override;
+	void fetchMore(const QModelIndex &parent) override;
+
+private:
+	QFile _file;
+	QByteArrayView _data;
+	ReportArchive::Reader _reader; // indexing position
+	bool _at_end;
+	std::vector<qsizetype> _offsets; // report record offset for each row
+	// Names from each Type record, they are not added to the
+	// AnnouncementTypeList of the live reports. Rows keep the name
+	// their type index had when they were read (older archives may
+	// reuse indices).
+	std::vector<QByteArray> _type_names;
+	std::vector<int> _type_slots; // archive type index to _type_names index
+	std::vector<int> _types; // _type_names index for each row
+	QHash<int, int> _repeats; // repeat count updates by report id
+	DF::PrettyDateCache _date_cache;
+};
+
+#endif
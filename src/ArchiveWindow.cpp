@@ -0,0 +1,82 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ArchiveWindow.h"
+
+#include <QClipboard>
+#include <QFileInfo>
+#include <QGuiApplication>
+
+#include "ui_ArchiveWindow.h"
+
+#include "Application.h"
+#include "ColumnWidthTracker.h"
+#include "ReportModel.h"
+
+// Rows measured for the column widths in each batch of fetched rows
+static constexpr int ArchiveWidthSampleSize = 100;
+
+ArchiveWindow::ArchiveWindow(QWidget *parent):
+	QMainWindow(parent),
+	_ui(std::make_unique<Ui::ArchiveWindow>())
+{
+	_ui->setupUi(this);
+
+	// Rows are decoded lazily, avoid ResizeToContents which would read
+	// every fetched row on each change. Widths are measured from a
+	// sample of each fetched batch.
+	_ui->view_reports->setModel(&_model);
+	_ui->view_reports->header()->setSectionHidden(static_cast<int>(ReportModel::Columns::Id), true);
+	_ui->view_reports->header()->setSectionHidden(static_cast<int>(ReportModel::Columns::Type), true);
+	new ColumnWidthTracker(_ui->view_reports, {
+			static_cast<int>(ReportModel::Columns::Id),
+			static_cast<int>(ReportModel::Columns::Date),
+			static_cast<int>(ReportModel::Columns::Type)},
+			ArchiveWidthSampleSize);
+	_ui->view_reports->setContextMenuPolicy(Qt::CustomContextMenu);
+	connect(_ui->view_reports, &QWidget::customContextMenuRequested,
+		[this](const QPoint &pos) {
+			_ui->menu_edit->exec(_ui->view_reports->mapToGlobal(pos));
+		});
+	// Only the visible rows need to be painted again with the new colors
+	connect(&Application::instance()->settings()->color_palette, &ColorPaletteModel::colorsChanged,
+		_ui->view_reports->viewport(), qOverload<>(&QWidget::update));
+}
+
+ArchiveWindow::~ArchiveWindow()
+{
+}
+
+bool ArchiveWindow::open(const QString &path)
+{
+	if (!_model.open(path))
+		return false;
+	setWindowTitle(tr("Report Archive - %1").arg(QFileInfo(path).completeBaseName()));
+	return true;
+}
+
+void ArchiveWindow::on_action_copy_triggered()
+{
+	auto selection = _ui->view_reports->selectionModel()->selectedRows(static_cast<int>(ReportModel::Columns::Text));
+	QString text;
+	for (const auto &index: selection) {
+		text.append(index.data().toString());
+		text.append("\n");
+	}
+	QGuiApplication::clipboard()->setText(text);
+}
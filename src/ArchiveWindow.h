@@ -0,0 +1,45 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ARCHIVE_WINDOW_H
+#define ARCHIVE_WINDOW_H
+
+#include <QMainWindow>
+
+namespace Ui { class ArchiveWindow; }
+
+#include "ArchiveModel.h"
+
+class ArchiveWindow: public QMainWindow
+{
+	Q_OBJECT
+public:
+	ArchiveWindow(QWidget *parent = nullptr);
+	~ArchiveWindow() override;
+
+	bool open(const QString &path);
+
+private slots:
+	void on_action_copy_triggered();
+
+private:
+	std::unique_ptr<Ui::ArchiveWindow> _ui;
+	ArchiveModel _model;
+};
+
+#endif
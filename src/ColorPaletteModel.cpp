@@ -21,6 +21,7 @@
 #include <QGuiApplication>
 #include <QPalette>
 #include <QSettings>
+#include <QStyleHints>
 
 struct color_def {
 	const char *prop_name;
@@ -63,9 +64,21 @@ static const std::array<color_def, ColorPaletteModel::ColorCount> ColorDefs = {
 		QColor(0, 0, 0), QColor(255, 255, 255)},
 };
 
+static bool isDarkTheme()
+{
+	auto application_palette = QGuiApplication::palette();
+	return application_palette.text().color().lightness() > application_palette.base().color().lightness();
+}
+
 ColorPaletteModel::ColorPaletteModel(QObject *parent):
-	QAbstractTableModel(parent)
+	QAbstractTableModel(parent),
+	_dark_theme(isDarkTheme())
 {
+	// The theme is only checked again when the palette changes
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+	connect(QGuiApplication::styleHints(), &QStyleHints::colorSchemeChanged,
+		this, &ColorPaletteModel::updateTheme);
+#endif
 	load();
 }
 
@@ -133,29 +146,31 @@ bool ColorPaletteModel::setData(const QModelIndex &index, const QVariant &value,
 		return false;
 	_colors[index.row()][index.column()] = value.value<QColor>();
 	dataChanged(index, index);
+	updateBrushes();
 	return true;
 }
 
-QColor ColorPaletteModel::color(int index) const
+void ColorPaletteModel::updateTheme()
 {
-	const auto &color = _colors[index];
-	// TODO: use QGuiApplication::styleHints()->colorScheme() (Qt >= 6.5)
-	auto application_palette = static_cast<QGuiApplication *>(QCoreApplication::instance())->palette();
-	if (application_palette.text().color().lightness() < application_palette.base().color().lightness()) {
-		// light theme
-		return color[0];
-	}
-	else {
-		// dark theme
-		return color[1];
+	if (bool dark_theme = isDarkTheme(); dark_theme != _dark_theme) {
+		_dark_theme = dark_theme;
+		updateBrushes();
 	}
 }
 
+void ColorPaletteModel::updateBrushes()
+{
+	for (std::size_t i = 0; i < ColorCount; ++i)
+		_brushes[i] = QBrush(_colors[i][_dark_theme ? 1 : 0]);
+	colorsChanged();
+}
+
 void ColorPaletteModel::reset(const QModelIndex &index)
 {
 	std::size_t row = index.row(), col = index.column();
 	_colors[row][col] = ColorDefs[row].default_color[col];
 	dataChanged(index, index);
+	updateBrushes();
 }
 
 void ColorPaletteModel::resetAll()
@@ -164,6 +179,7 @@ void ColorPaletteModel::resetAll()
 		for (std::size_t j = 0; j < 2; ++j)
 			_colors[i][j] = ColorDefs[i].default_color[j];
 	dataChanged(index(0, 0), index(ColorCount-1, 1));
+	updateBrushes();
 }
 
 
@@ -184,6 +200,7 @@ void ColorPaletteModel::load()
 		settings.endGroup();
 	}
 	settings.endGroup();
+	updateBrushes();
 }
 
 void ColorPaletteModel::save() const
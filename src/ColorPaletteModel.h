@@ -20,6 +20,7 @@
 #define COLOR_PALETTE_MODEL_H
 
 #include <QAbstractTableModel>
+#include <QBrush>
 #include <QColor>
 
 class ColorPaletteModel: public QAbstractTableModel
@@ -38,7 +39,9 @@ public:
 	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
 	bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
 
-	QColor color(int index) const;
+	// Colors for the current theme
+	const QColor &color(int index) const { return _brushes[index].color(); }
+	const QBrush &brush(int index) const { return _brushes[index]; }
 
 	void reset(const QModelIndex &index);
 	void resetAll();
@@ -46,8 +49,20 @@ public:
 	void load();
 	void save() const;
 
+	// Check the theme again after the application palette changed
+	// (called by Application)
+	void updateTheme();
+
+signals:
+	// The colors of the current theme changed (edited or theme changed)
+	void colorsChanged();
+
 private:
+	void updateBrushes();
+
 	std::array<std::array<QColor, 2>, ColorCount> _colors;
+	bool _dark_theme;
+	std::array<QBrush, ColorCount> _brushes;
 };
 
 #endif
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ColumnWidthTracker.h"
+
+#include <QHeaderView>
+#include <QStyle>
+#include <QTreeView>
+
+#include <algorithm>
+
+ColumnWidthTracker::ColumnWidthTracker(QTreeView *view, std::initializer_list<int> columns, int max_rows):
+	QObject(view),
+	_view(view),
+	_columns(columns),
+	_widths(columns.size(), 0),
+	_max_rows(max_rows)
+{
+	_view->header()->setSectionResizeMode(QHeaderView::Interactive);
+	_view->header()->setStretchLastSection(true);
+	auto model = _view->model();
+	connect(model, &QAbstractItemModel::rowsInserted,
+		this, &ColumnWidthTracker::rowsInserted);
+	connect(model, &QAbstractItemModel::modelReset,
+		this, &ColumnWidthTracker::reset);
+	connect(model, &QAbstractItemModel::layoutChanged,
+		this, &ColumnWidthTracker::reset);
+	// Hiding or showing a section resizes it from or to 0
+	connect(_view->header(), &QHeaderView::sectionResized,
+		this, &ColumnWidthTracker::sectionResized);
+	reset();
+}
+
+ColumnWidthTracker::~ColumnWidthTracker()
+{
+}
+
+void ColumnWidthTracker::rowsInserted(const QModelIndex &parent, int first, int last)
+{
+	if (!parent.isValid())
+		measure(first, last);
+}
+
+void ColumnWidthTracker::reset()
+{
+	for (auto &width: _widths)
+		width = 0;
+	measure(0, _view->model()->rowCount() - 1);
+}
+
+void ColumnWidthTracker::sectionResized(int logical_index, int old_size, int new_size)
+{
+	auto it = std::ranges::find(_columns, logical_index);
+	if (it == _columns.end())
+		return;
+	std::size_t i = std::distance(_columns.begin(), it);
+	if (new_size == 0)
+		_widths[i] = -1;
+	else if (old_size == 0 && _widths[i] < 0) {
+		_widths[i] = 0;
+		measureColumn(i, 0, _view->model()->rowCount() - 1);
+	}
+}
+
+void ColumnWidthTracker::measure(int first, int last)
+{
+	for (std::size_t i = 0; i < _columns.size(); ++i)
+		measureColumn(i, first, last);
+}
+
+void ColumnWidthTracker::measureColumn(std::size_t i, int first, int last)
+{
+	auto header = _view->header();
+	if (header->isSectionHidden(_columns[i])) {
+		_widths[i] = -1;
+		return;
+	}
+	auto model = _view->model();
+	auto metrics = _view->fontMetrics();
+	// Same margins as the default item delegate
+	int margin = 2 * (_view->style()->pixelMetric(QStyle::PM_FocusFrameHMargin, nullptr, _view) + 1);
+	int width = std::max(_widths[i], header->sectionSizeHint(_columns[i]));
+	int step = _max_rows > 0 ? std::max(1, (last - first + 1) / _max_rows) : 1;
+	for (int row = first; row <= last; row += step) {
+		auto text = model->index(row, _columns[i]).data().toString();
+		width = std::max(width, metrics.horizontalAdvance(text) + margin);
+	}
+	if (width != _widths[i]) {
+		_widths[i] = width;
+		header->resizeSection(_columns[i], width);
+	}
+}
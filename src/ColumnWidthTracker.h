@@ -0,0 +1,58 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COLUMN_WIDTH_TRACKER_H
+#define COLUMN_WIDTH_TRACKER_H
+
+#include <QObject>
+
+#include <initializer_list>
+#include <vector>
+
+class QTreeView;
+
+// Size the columns of a view from the rows inserted in its model, instead
+// of QHeaderView::ResizeToContents measuring every row on each change.
+// Widths only grow, they are measured again from all rows after a reset.
+// Hidden columns are not measured until they are shown. When max_rows is
+// not 0, only a sample of that many rows is measured from each insertion
+// (for models whose data is expensive to read).
+// The view must have its model set, its last section is stretched.
+class ColumnWidthTracker: public QObject
+{
+	Q_OBJECT
+public:
+	ColumnWidthTracker(QTreeView *view, std::initializer_list<int> columns, int max_rows = 0);
+	~ColumnWidthTracker() override;
+
+private slots:
+	void rowsInserted(const QModelIndex &parent, int first, int last);
+	void reset();
+	void sectionResized(int logical_index, int old_size, int new_size);
+
+private:
+	void measure(int first, int last);
+	void measureColumn(std::size_t i, int first, int last);
+
+	QTreeView *_view;
+	std::vector<int> _columns;
+	std::vector<int> _widths; // -1 while the column is hidden
+	int _max_rows;
+};
+
+#endif
@@ -19,7 +19,11 @@
 #ifndef DF_TIME_H
 #define DF_TIME_H
 
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <optional>
+#include <QHash>
 #include <QString>
 
 namespace DF {
@@ -76,30 +80,97 @@ struct date: std::tuple<Ds...>
 	}
 };
 
+constexpr QLatin1String daySuffix(int32_t day)
+{
+	switch (day) {
+	case 1:
+	case 21:
+		return QLatin1String("st");
+	case 2:
+	case 22:
+		return QLatin1String("nd");
+	case 3:
+	case 23:
+		return QLatin1String("rd");
+	default:
+		return QLatin1String("th");
+	}
+}
+
 template <typename Rep, typename Period>
 QString prettyDate(std::chrono::duration<Rep, Period> duration) {
 	auto d = date<year, month, day>(duration);
-	return QString("%1%2 %3 %4")
-		.arg(std::get<2>(d).count()+1)
-		.arg([](int32_t day){
-			switch (day) {
-			case 1:
-			case 21:
-				return "st";
-			case 2:
-			case 22:
-				return "nd";
-			case 3:
-			case 23:
-				return "rd";
-			default:
-				return "th";
-			}
-		}(std::get<2>(d).count()+1))
-		.arg(Months[std::get<1>(d).count()])
-		.arg(std::get<0>(d).count());
+	auto day_of_month = std::get<2>(d).count()+1;
+	QString str;
+	str.reserve(24);
+	str.append(QString::number(day_of_month));
+	str.append(daySuffix(day_of_month));
+	str.append(u' ');
+	str.append(Months[std::get<1>(d).count()]);
+	str.append(u' ');
+	str.append(QString::number(std::get<0>(d).count()));
+	return str;
+}
+
+// Parse "YEAR[-MONTH[-DAY]]" or "YEAR-SEASON" (MONTH is a name or a
+// number) into the range [begin, end) of the year, season, month or day.
+inline std::optional<std::pair<time, time>> parseDateRange(QStringView value)
+{
+	auto parts = value.split(u'-');
+	bool ok = parts.size() <= 3;
+	int y = ok ? parts[0].toInt(&ok) : 0;
+	int m = 0, d = 0;
+	time length = year(1);
+	auto named = [](const auto &names, QStringView value) {
+		return std::distance(names.begin(), std::ranges::find_if(names, [value](QStringView name) {
+				return name.compare(value, Qt::CaseInsensitive) == 0;
+			}));
+	};
+	if (ok && parts.size() > 1) {
+		if (auto s = named(Seasons, parts[1]); s < int(Seasons.size())) {
+			m = 3*s;
+			length = season(1);
+			ok = parts.size() == 2;
+		}
+		else {
+			m = named(Months, parts[1]);
+			if (m == int(Months.size()))
+				m = parts[1].toInt(&ok) - 1;
+			length = month(1);
+		}
+		ok = ok && m >= 0 && m < 12;
+	}
+	if (ok && parts.size() > 2) {
+		d = parts[2].toInt(&ok) - 1;
+		ok = ok && d >= 0 && d < 28;
+		length = day(1);
+	}
+	if (!ok || y < 0)
+		return std::nullopt;
+	time begin = time(year(y)) + month(m) + day(d);
+	return std::pair{begin, begin + length};
 }
 
+// Reports are grouped on a few days, their formatted dates are cached by
+// day. The cache is cleared when it grows too large.
+class PrettyDateCache
+{
+public:
+	const QString &operator()(time t) const {
+		auto key = std::chrono::floor<day>(t).count();
+		auto it = _dates.constFind(key);
+		if (it != _dates.constEnd())
+			return *it;
+		if (_dates.size() >= MaxSize)
+			_dates.clear();
+		return *_dates.insert(key, prettyDate(t));
+	}
+
+private:
+	static constexpr qsizetype MaxSize = 4096;
+	mutable QHash<int64_t, QString> _dates;
+};
+
 }
 
 #endif
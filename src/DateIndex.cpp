@@ -0,0 +1,57 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DateIndex.h"
+
+#include <limits>
+
+DateIndex::DateIndex():
+	_last_month(std::numeric_limits<qint32>::min())
+{
+}
+
+void DateIndex::append(qint64 position, DF::time time)
+{
+	auto month = std::chrono::floor<DF::month>(time).count();
+	if (month > _last_month) {
+		_months.insert(month, position);
+		_last_month = month;
+	}
+}
+
+void DateIndex::removeBefore(qint64 position)
+{
+	// The first kept month may start before position
+	while (_months.size() > 1 && std::next(_months.begin()).value() <= position)
+		_months.erase(_months.begin());
+}
+
+void DateIndex::clear()
+{
+	_months.clear();
+	_last_month = std::numeric_limits<qint32>::min();
+}
+
+std::optional<std::pair<qint64, std::optional<qint64>>> DateIndex::find(DF::time time) const
+{
+	auto it = _months.lowerBound(std::chrono::floor<DF::month>(time).count());
+	if (it == _months.end())
+		return std::nullopt;
+	auto next = std::next(it);
+	return std::pair{it.value(), next == _months.end() ? std::nullopt : std::optional(next.value())};
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef DATE_INDEX_H
+#define DATE_INDEX_H
+
+#include <QMap>
+
+#include <optional>
+#include <utility>
+
+#include "DFTime.h"
+
+// Sparse index of the position where each month starts. Reports are
+// almost sorted by date, a month starts at the first report reaching it
+// (later reports from an older month do not create entries).
+class DateIndex
+{
+public:
+	DateIndex();
+
+	// Positions must be increasing
+	void append(qint64 position, DF::time time);
+	// Drop the months entirely before position
+	void removeBefore(qint64 position);
+	void clear();
+
+	// Positions [begin, end) of the first indexed month containing or
+	// following time, end is empty for the last month.
+	std::optional<std::pair<qint64, std::optional<qint64>>> find(DF::time time) const;
+
+private:
+	QMap<qint32, qint64> _months;
+	qint32 _last_month;
+};
+
+#endif
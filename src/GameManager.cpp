@@ -23,6 +23,26 @@
 #include "ReportModel.h"
 
 #include <QEventLoop>
+#include <QRegularExpression>
+#include <QtConcurrent>
+
+// Maximum time (ms) the server keeps a Wait call pending
+static constexpr int WaitReportsTimeout = 5000;
+// Number of updates without new reports before the interval starts growing
+static constexpr int QuietUpdateCount = 3;
+
+static QString archiveName(ReportSource source, QString world)
+{
+	world.replace(QRegularExpression("[^A-Za-z0-9_-]"), "_");
+	switch (source) {
+	case ReportSource::Announcements:
+		return QString("%1-announcements").arg(world);
+	case ReportSource::Reports:
+		return QString("%1-reports").arg(world);
+	default:
+		Q_UNREACHABLE();
+	}
+}
 
 GameManager::GameManager(QObject *parent):
 	QObject(parent),
@@ -31,7 +51,15 @@ GameManager::GameManager(QObject *parent):
 	_get_version(&_dfhack),
 	_get_df_version(&_dfhack),
 	_get_announcements(&_dfhack),
-	_get_reports(&_dfhack)
+	_get_reports(&_dfhack),
+	_get_announcements_since(&_dfhack),
+	_get_reports_since(&_dfhack),
+	_has_reports_since(false),
+	_wait_announcements(&_dfhack),
+	_wait_reports(&_dfhack),
+	_has_wait_reports(false),
+	_waiting(false),
+	_quiet_updates(0)
 {
 	auto settings = Application::instance()->settings();
 	QObject::connect(
@@ -42,9 +70,16 @@ GameManager::GameManager(QObject *parent):
 		this, &GameManager::onNotification);
 	QObject::connect(
 		&settings->report_source, &SettingPropertyBase::valueChanged,
-		this, &GameManager::update);
+		this, &GameManager::onReportSourceChanged);
+	for (auto property: {
+			&settings->autorefresh_interval,
+			&settings->autorefresh_min_interval,
+			&settings->autorefresh_max_interval})
+		QObject::connect(
+			property, &SettingPropertyBase::valueChanged,
+			this, &GameManager::onAutorefreshIntervalChanged);
 	QObject::connect(
-		&settings->autorefresh_interval, &SettingPropertyBase::valueChanged,
+		&settings->autorefresh_adaptive, &SettingPropertyBase::valueChanged,
 		this, &GameManager::onAutorefreshIntervalChanged);
 	onAutorefreshIntervalChanged();
 	QObject::connect(
@@ -54,6 +89,12 @@ GameManager::GameManager(QObject *parent):
 	QObject::connect(
 		&_refresh_timer, &QTimer::timeout,
 		this, &GameManager::update);
+	QObject::connect(
+		&settings->history_archive, &SettingPropertyBase::valueChanged,
+		this, &GameManager::onArchiveEnabledChanged);
+	// Show the archived reports from the last session before connecting
+	if (settings->history_archive() && !settings->history_archive_name().isEmpty())
+		_reports->openArchive(settings->history_archive_name());
 }
 
 GameManager::~GameManager()
@@ -99,6 +140,22 @@ void GameManager::connect(const QString &host, quint16 port)
 			_dfhack.disconnect();
 			throw tr("Failed to bind functions");
 		}
+		// Incremental updates are optional, older plugins only support full updates
+		return DFHack::bindAll(
+			_get_announcements_since,
+			_get_reports_since
+		);
+	}).unwrap().then(this, [this](bool success) {
+		_has_reports_since = success;
+		if (!success)
+			return QtFuture::makeReadyFuture(false);
+		// Pushed updates are optional too, otherwise the timer is used
+		return DFHack::bindAll(
+			_wait_announcements,
+			_wait_reports
+		);
+	}).unwrap().then(this, [this](bool success) {
+		_has_wait_reports = success;
 		auto calls = QList<QFuture<VersionReply>>()
 			<< _get_version.call().first
 			<< _get_df_version.call().first;
@@ -129,8 +186,28 @@ void GameManager::update()
 	if (_state != Connected)
 		return;
 	auto settings = Application::instance()->settings();
-	auto result = [this, settings]() {
-		switch (settings->report_source()) {
+	auto source = settings->report_source();
+	// The reply is merged from the cursor the request was sent with,
+	// another update may have moved _cursor in the meantime.
+	std::optional<ReportCursor> request_cursor;
+	if (_has_reports_since)
+		request_cursor = _cursor;
+	bool partial = request_cursor.has_value();
+	auto result = [this, source, &request_cursor]() {
+		if (request_cursor) {
+			dfproto::Reports::ReportListRequest request;
+			request.set_last_id(request_cursor->last_id);
+			request.set_first_id(request_cursor->first_id);
+			switch (source) {
+			case ReportSource::Announcements:
+				return _get_announcements_since.call(request).first;
+			case ReportSource::Reports:
+				return _get_reports_since.call(request).first;
+			default:
+				Q_UNREACHABLE();
+			}
+		}
+		switch (source) {
 		case ReportSource::Announcements:
 			return _get_announcements.call().first;
 		case ReportSource::Reports:
@@ -139,16 +216,15 @@ void GameManager::update()
 			Q_UNREACHABLE();
 		}
 	}();
-	using Reply = DFHack::CallReply<dfproto::Reports::ReportList>;
-	result.then(this, [this, settings](Reply reply) {
+	result.then(this, [this, settings, source, partial, request_cursor](ReportListReply reply) {
+		if (source != settings->report_source() || (partial && !_cursor))
+			return; // the source changed while waiting, this reply is outdated
 		if (!reply) {
 			error(tr("Failed to get reports"));
+			scheduleUpdate();
 		}
-		else {
-			_reports->update(*reply);
-		}
-		if (settings->autorefresh_enabled())
-			_refresh_timer.start();
+		else
+			applyReports(std::move(reply), request_cursor);
 	});
 }
 
@@ -156,11 +232,30 @@ void GameManager::onConnectionChanged(bool connected)
 {
 	if (!connected) {
 		_refresh_timer.stop();
-		_reports->clear();
+		_waiting = false;
+		_cursor.reset();
+		// Archived reports stay visible until the next connection
+		if (!_reports->hasArchive())
+			_reports->clear();
 		setState(Disconnected);
 	}
 }
 
+void GameManager::onReportSourceChanged()
+{
+	// Ids from the other source are meaningless, start again with a full update
+	_cursor.reset();
+	update();
+}
+
+void GameManager::onArchiveEnabledChanged()
+{
+	if (Application::instance()->settings()->history_archive())
+		_cursor.reset(); // the archive is opened by the next full update
+	else
+		_reports->closeArchive();
+}
+
 void GameManager::onNotification(DFHack::Color color, const QString &text)
 {
 	qInfo() << text;
@@ -168,7 +263,13 @@ void GameManager::onNotification(DFHack::Color color, const QString &text)
 
 void GameManager::onAutorefreshIntervalChanged()
 {
-	auto interval = Application::instance()->settings()->autorefresh_interval();
+	auto settings = Application::instance()->settings();
+	auto interval = settings->autorefresh_interval();
+	if (settings->autorefresh_adaptive()) {
+		interval = std::min(interval, settings->autorefresh_max_interval());
+		interval = std::max(interval, settings->autorefresh_min_interval());
+	}
+	_quiet_updates = 0;
 	_refresh_timer.setInterval(interval*1000);
 }
 
@@ -176,7 +277,7 @@ void GameManager::onAutorefreshEnabledChanged()
 {
 	auto enabled = Application::instance()->settings()->autorefresh_enabled();
 	if (enabled)
-		_refresh_timer.start();
+		scheduleUpdate();
 	else
 		_refresh_timer.stop();
 }
@@ -186,3 +287,133 @@ void GameManager::setState(State state)
 	if (_state != state)
 		stateChanged(_state = state);
 }
+
+void GameManager::applyReports(ReportListReply &&reply, std::optional<ReportCursor> request_cursor)
+{
+	std::optional<int> last_id;
+	std::optional<ReportCursor> cursor;
+	const auto &df_reports = reply->reports();
+	if (request_cursor) {
+		last_id = request_cursor->last_id;
+		cursor = request_cursor;
+		if (!df_reports.empty())
+			cursor->last_id = df_reports.rbegin()->id();
+		if (reply->has_first_id())
+			cursor->first_id = reply->first_id();
+	}
+	else {
+		if (!df_reports.empty())
+			cursor = ReportCursor{df_reports.begin()->id(), df_reports.rbegin()->id()};
+		auto settings = Application::instance()->settings();
+		if (settings->history_archive() && !reply->world().empty()) {
+			// Load the archive for this world and source, the received
+			// reports are then merged with the archived ones by id.
+			auto name = archiveName(settings->report_source(), QString::fromStdString(reply->world()));
+			if (name != _reports->archiveName()) {
+				if (_reports->openArchive(name))
+					settings->history_archive_name = name;
+				else {
+					// Reports from another world must not be
+					// appended to its archive
+					qWarning() << "Failed to open archive" << ReportArchive::path(name);
+					_reports->closeArchive();
+					_reports->clear();
+				}
+			}
+		}
+		else if (_reports->hasArchive()) {
+			// Report ids are only unique in a save, without its name
+			// the reports cannot be archived or merged with the
+			// archive from the last session.
+			if (settings->history_archive())
+				qWarning() << "The server does not send the world name, reports are not archived";
+			_reports->closeArchive();
+			_reports->clear();
+		}
+	}
+	// Decoding new reports and comparing them with the current ones is
+	// done in a worker thread, only the resulting changes are applied here.
+	QtConcurrent::run([snapshot = _reports->snapshot(), reply = std::move(reply), last_id]() {
+		return ReportModel::diff(snapshot, *reply, last_id);
+	}).then(this, [this, cursor, request_cursor](QFuture<ReportModel::Changes> changes) {
+		// If the model was modified in the meantime, the changes are
+		// dropped and the cursor is kept for fetching them again.
+		if (_reports->apply(changes.takeResult())) {
+			adaptRefreshInterval(cursor && (!_cursor || cursor->last_id != _cursor->last_id));
+			// A reply to an older partial request does not move the
+			// cursor back
+			if (!request_cursor || !_cursor || cursor->last_id >= _cursor->last_id)
+				_cursor = cursor;
+		}
+		scheduleUpdate();
+	});
+}
+
+void GameManager::scheduleUpdate()
+{
+	if (_state != Connected || !Application::instance()->settings()->autorefresh_enabled())
+		return;
+	if (_has_wait_reports && _cursor)
+		waitReports();
+	else
+		_refresh_timer.start();
+}
+
+void GameManager::waitReports()
+{
+	if (_waiting)
+		return;
+	_waiting = true;
+	auto settings = Application::instance()->settings();
+	auto source = settings->report_source();
+	auto request_cursor = *_cursor;
+	dfproto::Reports::ReportListRequest request;
+	request.set_last_id(request_cursor.last_id);
+	request.set_first_id(request_cursor.first_id);
+	request.set_timeout(WaitReportsTimeout);
+	auto result = [this, source, &request]() {
+		switch (source) {
+		case ReportSource::Announcements:
+			return _wait_announcements.call(request).first;
+		case ReportSource::Reports:
+			return _wait_reports.call(request).first;
+		default:
+			Q_UNREACHABLE();
+		}
+	}();
+	result.then(this, [this, settings, source, request_cursor](ReportListReply reply) {
+		if (!_waiting)
+			return; // disconnected while waiting
+		_waiting = false;
+		// Ignore the reply if a full update was requested while waiting
+		if (source == settings->report_source() && _cursor) {
+			if (!reply) {
+				// Stop waiting on a failing server, fall back to polling
+				_has_wait_reports = false;
+				error(tr("Failed to get reports"));
+			}
+			else {
+				applyReports(std::move(reply), request_cursor);
+				return;
+			}
+		}
+		scheduleUpdate();
+	});
+}
+
+void GameManager::adaptRefreshInterval(bool new_reports)
+{
+	auto settings = Application::instance()->settings();
+	if (!settings->autorefresh_adaptive())
+		return;
+	if (new_reports) {
+		// Something is happening, refresh as fast as allowed
+		_quiet_updates = 0;
+		_refresh_timer.setInterval(settings->autorefresh_min_interval()*1000);
+	}
+	else if (++_quiet_updates >= QuietUpdateCount) {
+		// Back off exponentially while the game is quiet
+		int max_interval = settings->autorefresh_max_interval()*1000;
+		_refresh_timer.setInterval(std::min(_refresh_timer.interval()*2, max_interval));
+	}
+}
@@ -22,6 +22,8 @@
 #include <QObject>
 #include <QTimer>
 
+#include <optional>
+
 #include <dfhack-client-qt/Client.h>
 #include <dfhack-client-qt/Function.h>
 #include <dfhack-client-qt/Basic.h>
@@ -39,6 +41,22 @@ using GetReports = DFHack::Function<
 	"Reports", "GetReports",
 	dfproto::EmptyMessage,
 	dfproto::Reports::ReportList>;
+using GetAnnouncementsSince = DFHack::Function<
+	"Reports", "GetAnnouncementsSince",
+	dfproto::Reports::ReportListRequest,
+	dfproto::Reports::ReportList>;
+using GetReportsSince = DFHack::Function<
+	"Reports", "GetReportsSince",
+	dfproto::Reports::ReportListRequest,
+	dfproto::Reports::ReportList>;
+using WaitAnnouncements = DFHack::Function<
+	"Reports", "WaitAnnouncements",
+	dfproto::Reports::ReportListRequest,
+	dfproto::Reports::ReportList>;
+using WaitReports = DFHack::Function<
+	"Reports", "WaitReports",
+	dfproto::Reports::ReportListRequest,
+	dfproto::Reports::ReportList>;
 }
 
 class GameManager: public QObject
@@ -73,12 +91,26 @@ signals:
 
 private slots:
 	void onConnectionChanged(bool);
+	void onReportSourceChanged();
+	void onArchiveEnabledChanged();
 	void onNotification(DFHack::Color color, const QString &text);
 	void onAutorefreshIntervalChanged();
 	void onAutorefreshEnabledChanged();
 
 private:
 	void setState(State state);
+	void scheduleUpdate();
+	void waitReports();
+	void adaptRefreshInterval(bool new_reports);
+	using ReportListReply = DFHack::CallReply<dfproto::Reports::ReportList>;
+	// Range of report ids received from the last update
+	struct ReportCursor {
+		int first_id;
+		int last_id;
+	};
+	// request_cursor is the cursor a partial request was sent with, it is
+	// empty for full updates
+	void applyReports(ReportListReply &&reply, std::optional<ReportCursor> request_cursor);
 
 	std::unique_ptr<ReportModel> _reports;
 
@@ -91,8 +123,18 @@ private:
 	DFHack::Basic::GetDFVersion _get_df_version;
 	Reports::GetAnnouncements _get_announcements;
 	Reports::GetReports _get_reports;
+	Reports::GetAnnouncementsSince _get_announcements_since;
+	Reports::GetReportsSince _get_reports_since;
+	bool _has_reports_since;
+	Reports::WaitAnnouncements _wait_announcements;
+	Reports::WaitReports _wait_reports;
+	bool _has_wait_reports;
+	bool _waiting;
+
+	std::optional<ReportCursor> _cursor;
 
 	QTimer _refresh_timer;
+	int _quiet_updates;
 };
 
 #endif
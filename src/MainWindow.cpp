@@ -19,14 +19,20 @@
 #include "MainWindow.h"
 
 #include <QClipboard>
+#include <QFileDialog>
+#include <QInputDialog>
 #include <QMessageBox>
 #include <QScrollBar>
 #include <QSortFilterProxyModel>
 
+#include <limits>
+
 #include "ui_MainWindow.h"
 #include "ui_AboutDialog.h"
 
 #include "Application.h"
+#include "ArchiveWindow.h"
+#include "ColumnWidthTracker.h"
 #include "ReportModel.h"
 #include "AnnouncementTypeList.h"
 #include "SettingsDialog.h"
@@ -45,10 +51,23 @@ MainWindow::MainWindow(QWidget *parent):
 	// Report views
 	auto model = _game_manager.reports();
 	_report_filter.setSourceModel(model);
-	_report_filter.setFilterKeyColumn(static_cast<int>(ReportModel::Columns::Text));
-	_report_filter.setFilterCaseSensitivity(Qt::CaseInsensitive);
 	connect(_ui->edit_filter_text, &QLineEdit::textChanged,
-		&_report_filter, &QSortFilterProxyModel::setFilterWildcard);
+		[this](const QString &text) {
+			// Invalid queries are ignored until they are fixed
+			ReportQuery query(text);
+			if (query.isValid()) {
+				_ui->edit_filter_text->setToolTip({});
+				_report_filter.setQuery(std::move(query));
+			}
+			else {
+				_ui->edit_filter_text->setToolTip(query.errorString());
+				_ui->statusbar->showMessage(tr("Invalid query: %1").arg(query.errorString()), 5000);
+			}
+		});
+	connect(_ui->edit_date_from, &QLineEdit::textChanged,
+		this, &MainWindow::updateDateRange);
+	connect(_ui->edit_date_to, &QLineEdit::textChanged,
+		this, &MainWindow::updateDateRange);
 	connect(&_report_filter, &QAbstractItemModel::rowsAboutToBeRemoved,
 		[this](const QModelIndex &parent, int start, int end) {
 			// Clear current index if the row is removed so
@@ -64,11 +83,14 @@ MainWindow::MainWindow(QWidget *parent):
 			}
 		});
 	_ui->view_reports->setModel(&_report_filter);
-	_ui->view_reports->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
-	_ui->view_reports->header()->setStretchLastSection(true);
 	_ui->view_reports->header()->setContextMenuPolicy(Qt::CustomContextMenu);
 	_ui->view_reports->header()->setSectionHidden(static_cast<int>(ReportModel::Columns::Id), true);
 	_ui->view_reports->header()->setSectionHidden(static_cast<int>(ReportModel::Columns::Type), true);
+	// Hidden columns are measured when they are shown
+	new ColumnWidthTracker(_ui->view_reports, {
+			static_cast<int>(ReportModel::Columns::Id),
+			static_cast<int>(ReportModel::Columns::Date),
+			static_cast<int>(ReportModel::Columns::Type)});
 	connect(_ui->view_reports->header(), &QWidget::customContextMenuRequested,
 		[this](const QPoint &pos) {
 			auto model = _game_manager.reports();
@@ -91,7 +113,13 @@ MainWindow::MainWindow(QWidget *parent):
 		[this](const QPoint &pos) {
 			_ui->menu_edit->exec(_ui->view_reports->mapToGlobal(pos));
 		});
+	// Only the visible rows need to be painted again with the new colors
+	connect(&settings->color_palette, &ColorPaletteModel::colorsChanged,
+		_ui->view_reports->viewport(), qOverload<>(&QWidget::update));
+
 
+	// Statistics
+	_ui->view_statistics->setModel(model->statistics());
 
 	// Filters
 	_type_filter.setSourceModel(&settings->announcement_types);
@@ -110,6 +138,8 @@ MainWindow::MainWindow(QWidget *parent):
 	_ui->menu_view->addSeparator();
 	_ui->dock_filters->setVisible(false);
 	_ui->menu_view->addAction(_ui->dock_filters->toggleViewAction());
+	_ui->dock_statistics->setVisible(false);
+	_ui->menu_view->addAction(_ui->dock_statistics->toggleViewAction());
 
 	// Game manager
 	connect(_ui->action_disconnect, &QAction::triggered, &_game_manager, &GameManager::disconnect);
@@ -149,11 +179,15 @@ MainWindow::~MainWindow()
 
 void MainWindow::setAllTypes(bool checked)
 {
+	auto &type_list = Application::instance()->settings()->announcement_types;
 	int count = _type_filter.rowCount();
+	std::vector<int> type_ids;
+	type_ids.reserve(count);
 	for (int i = 0; i < count; ++i) {
-		auto index = _type_filter.index(i, 0);
-		_type_filter.setData(index, checked, Qt::CheckStateRole);
+		auto index = _type_filter.mapToSource(_type_filter.index(i, 0));
+		type_ids.push_back(type_list.typeIdAt(index.row()));
 	}
+	type_list.setTypesEnabled(type_ids, checked);
 }
 
 void MainWindow::on_action_connect_triggered()
@@ -168,6 +202,23 @@ void MainWindow::on_action_autorefresh_toggled(bool checked)
 	settings->autorefresh_enabled = checked;
 }
 
+void MainWindow::on_action_open_archive_triggered()
+{
+	auto path = QFileDialog::getOpenFileName(this, tr("Open Archive"),
+			ReportArchive::directory(),
+			tr("Report archives (*.dfreports)"));
+	if (path.isEmpty())
+		return;
+	auto window = new ArchiveWindow;
+	window->setAttribute(Qt::WA_DeleteOnClose);
+	if (window->open(path))
+		window->show();
+	else {
+		delete window;
+		QMessageBox::critical(this, tr("Error"), tr("Failed to open archive %1.").arg(path));
+	}
+}
+
 void MainWindow::on_action_open_settings_triggered()
 {
 	SettingsDialog dialog(this);
@@ -185,6 +236,64 @@ void MainWindow::on_action_copy_triggered()
 	QGuiApplication::clipboard()->setText(text);
 }
 
+void MainWindow::on_action_go_to_report_triggered()
+{
+	auto model = _game_manager.reports();
+	if (model->rowCount({}) == 0)
+		return;
+	auto current = _ui->view_reports->currentIndex();
+	bool ok;
+	int id = QInputDialog::getInt(this, tr("Go to Report"), tr("Report id:"),
+			current.isValid()
+				? model->reportId(_report_filter.mapToSource(current).row())
+				: model->reportId(model->rowCount({})-1),
+			std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), 1, &ok);
+	if (!ok)
+		return;
+	int row = model->rowForId(id);
+	if (row == -1) {
+		_ui->statusbar->showMessage(tr("Report %1 is not in the history").arg(id), 5000);
+		return;
+	}
+	auto index = _report_filter.mapFromSource(model->index(row, static_cast<int>(ReportModel::Columns::Text)));
+	if (!index.isValid()) {
+		_ui->statusbar->showMessage(tr("Report %1 is hidden by the filters").arg(id), 5000);
+		return;
+	}
+	_ui->action_follow->setChecked(false);
+	_ui->view_reports->setCurrentIndex(index);
+	_ui->view_reports->scrollTo(index, QAbstractItemView::PositionAtCenter);
+}
+
+void MainWindow::on_action_go_to_date_triggered()
+{
+	auto model = _game_manager.reports();
+	if (model->rowCount({}) == 0)
+		return;
+	bool ok;
+	auto text = QInputDialog::getText(this, tr("Go to Date"),
+			tr("Date (year[-season|-month[-day]]):"),
+			QLineEdit::Normal, {}, &ok);
+	if (!ok)
+		return;
+	auto range = DF::parseDateRange(text.trimmed());
+	if (!range) {
+		_ui->statusbar->showMessage(tr("Invalid date: %1").arg(text), 5000);
+		return;
+	}
+	// First report shown by the filters at or after the date
+	QModelIndex index;
+	for (int row = model->rowForTime(range->first); row < model->rowCount({}) && !index.isValid(); ++row)
+		index = _report_filter.mapFromSource(model->index(row, static_cast<int>(ReportModel::Columns::Text)));
+	if (!index.isValid()) {
+		_ui->statusbar->showMessage(tr("No report after %1").arg(text), 5000);
+		return;
+	}
+	_ui->action_follow->setChecked(false);
+	_ui->view_reports->setCurrentIndex(index);
+	_ui->view_reports->scrollTo(index, QAbstractItemView::PositionAtTop);
+}
+
 void MainWindow::on_action_about_triggered()
 {
 	QDialog dialog;
@@ -228,3 +337,29 @@ void MainWindow::updateViewScrollPosition()
 		_ui->view_reports->scrollToBottom();
 	}
 }
+
+void MainWindow::updateDateRange()
+{
+	// Both bounds are inclusive: from the beginning of the first date
+	// to the end of the last one. The range is not changed while a
+	// bound is invalid.
+	bool valid = true;
+	auto parse = [this, &valid](QLineEdit *edit) {
+		std::optional<std::pair<DF::time, DF::time>> range;
+		auto text = edit->text().trimmed();
+		if (!text.isEmpty() && !(range = DF::parseDateRange(text))) {
+			edit->setToolTip(tr("Invalid date, expected year[-season|-month[-day]]"));
+			valid = false;
+		}
+		else
+			edit->setToolTip({});
+		return range;
+	};
+	auto from = parse(_ui->edit_date_from);
+	auto to = parse(_ui->edit_date_to);
+	if (!valid)
+		return;
+	_report_filter.setDateRange(
+			from ? std::optional(from->first) : std::nullopt,
+			to ? std::optional(to->second) : std::nullopt);
+}
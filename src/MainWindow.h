@@ -41,12 +41,16 @@ private slots:
 private slots:
 	void on_action_connect_triggered();
 	void on_action_autorefresh_toggled(bool);
+	void on_action_open_archive_triggered();
 	void on_action_open_settings_triggered();
 	void on_action_copy_triggered();
+	void on_action_go_to_report_triggered();
+	void on_action_go_to_date_triggered();
 	void on_action_about_triggered();
 	void updateConnectionState(GameManager::State state);
 	void updateAutoRefreshAction();
 	void updateViewScrollPosition();
+	void updateDateRange();
 
 private:
 	std::unique_ptr<Ui::MainWindow> _ui;
@@ -0,0 +1,239 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ReportArchive.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QtEndian>
+
+#include "AnnouncementTypeList.h"
+
+static constexpr QByteArrayView ArchiveMagic = "DFREPORTS1";
+
+template <typename T>
+static void writeInt(QByteArray &buffer, T value)
+{
+	char bytes[sizeof(T)];
+	qToLittleEndian(value, bytes);
+	buffer.append(bytes, sizeof(T));
+}
+
+static void writeString(QByteArray &buffer, QByteArrayView string)
+{
+	writeInt<quint32>(buffer, string.size());
+	buffer.append(string);
+}
+
+ReportArchive::ReportArchive(const AnnouncementTypeList &type_list):
+	_type_list(type_list),
+	_last_id(0),
+	_type_count(0)
+{
+}
+
+ReportArchive::~ReportArchive()
+{
+}
+
+QString ReportArchive::directory()
+{
+	QDir dir(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation));
+	return dir.filePath("archives");
+}
+
+QString ReportArchive::path(const QString &name)
+{
+	return QDir(directory()).filePath(QString("%1.dfreports").arg(name));
+}
+
+bool ReportArchive::open(const QString &name, qint64 valid_size, int last_id, const std::vector<int> &type_ids)
+{
+	close();
+	auto file_path = path(name);
+	QDir().mkpath(QFileInfo(file_path).path());
+	_file.setFileName(file_path);
+	if (!_file.open(QIODevice::ReadWrite))
+		return false;
+	if (valid_size < ArchiveMagic.size()) {
+		_file.resize(0);
+		_file.write(ArchiveMagic.data(), ArchiveMagic.size());
+	}
+	else
+		_file.resize(valid_size);
+	_file.seek(_file.size());
+	_name = name;
+	_last_id = last_id;
+	// Types keep their index in the file, new types are appended
+	_type_count = valid_size < ArchiveMagic.size() ? 0 : int(type_ids.size());
+	for (int index = 0; index < _type_count; ++index) {
+		int type = type_ids[index];
+		if (type < 0)
+			continue;
+		if (std::size_t(type) >= _type_indices.size())
+			_type_indices.resize(type+1, -1);
+		_type_indices[type] = index;
+	}
+	return true;
+}
+
+void ReportArchive::close()
+{
+	if (_file.isOpen())
+		_file.close();
+	_name.clear();
+	_type_indices.clear();
+	_type_count = 0;
+}
+
+void ReportArchive::appendReport(int id, int end_id, DF::time time, int type, int color, int repeat, const QString &text)
+{
+	if (!isOpen() || id <= _last_id)
+		return; // already archived
+	_last_id = id;
+	QByteArray buffer;
+	if (std::size_t(type) >= _type_indices.size())
+		_type_indices.resize(type+1, -1);
+	if (_type_indices[type] < 0) {
+		_type_indices[type] = _type_count++;
+		buffer.append(char(TypeRecord));
+		writeInt<qint32>(buffer, _type_indices[type]);
+		writeString(buffer, _type_list.typeName(type));
+	}
+	buffer.append(char(ReportRecord));
+	writeInt<qint32>(buffer, id);
+	writeInt<qint64>(buffer, time.count());
+	writeInt<qint32>(buffer, _type_indices[type]);
+	writeInt<qint32>(buffer, color);
+	writeInt<qint32>(buffer, repeat);
+	writeString(buffer, text.toUtf8());
+	if (end_id != id) {
+		buffer.append(char(SpanRecord));
+		writeInt<qint32>(buffer, id);
+		writeInt<qint32>(buffer, end_id);
+	}
+	_file.write(buffer);
+}
+
+void ReportArchive::appendRepeat(int id, int repeat)
+{
+	if (!isOpen())
+		return;
+	QByteArray buffer;
+	buffer.append(char(RepeatRecord));
+	writeInt<qint32>(buffer, id);
+	writeInt<qint32>(buffer, repeat);
+	_file.write(buffer);
+}
+
+void ReportArchive::flush()
+{
+	if (isOpen())
+		_file.flush();
+}
+
+ReportArchive::Reader::Reader(QByteArrayView data):
+	_data(data),
+	_offset(0),
+	_next_offset(ArchiveMagic.size()),
+	_valid(data.startsWith(ArchiveMagic)),
+	_type(TypeRecord),
+	_type_index(0),
+	_id(0),
+	_repeat(0),
+	_end_id(0),
+	_color(0)
+{
+	if (!_valid)
+		_next_offset = 0;
+}
+
+int ReportArchive::Reader::recordId(QByteArrayView data, qsizetype offset)
+{
+	// The id follows the record type in report, repeat and span records
+	return qFromLittleEndian<qint32>(data.data() + offset + 1);
+}
+
+bool ReportArchive::Reader::next()
+{
+	_offset = _next_offset;
+	if (!_valid)
+		return false;
+	qsizetype pos = _offset;
+	auto read = [this, &pos]<typename T>(T &value) {
+		if (pos + qsizetype(sizeof(T)) > _data.size())
+			return false;
+		value = qFromLittleEndian<T>(_data.data() + pos);
+		pos += sizeof(T);
+		return true;
+	};
+	auto read_string = [this, &pos, &read]() {
+		quint32 length;
+		if (!read(length) || pos + qsizetype(length) > _data.size())
+			return false;
+		_string = _data.sliced(pos, length);
+		pos += length;
+		return true;
+	};
+	quint8 type;
+	if (!read(type))
+		return false;
+	bool complete;
+	switch (type) {
+	case TypeRecord: {
+		qint32 index;
+		complete = read(index) && index >= 0 && read_string();
+		_type_index = index;
+		break;
+	}
+	case ReportRecord: {
+		qint32 id, type_index, color, repeat;
+		qint64 time;
+		complete = read(id) && read(time) && read(type_index)
+			&& read(color) && read(repeat) && read_string();
+		_id = id;
+		_time = DF::time(time);
+		_type_index = type_index;
+		_color = color;
+		_repeat = repeat;
+		break;
+	}
+	case RepeatRecord: {
+		qint32 id, repeat;
+		complete = read(id) && read(repeat);
+		_id = id;
+		_repeat = repeat;
+		break;
+	}
+	case SpanRecord: {
+		qint32 id, end_id;
+		complete = read(id) && read(end_id);
+		_id = id;
+		_end_id = end_id;
+		break;
+	}
+	default:
+		complete = false;
+	}
+	if (!complete)
+		return false;
+	_type = static_cast<RecordType>(type);
+	_next_offset = pos;
+	return true;
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef REPORT_ARCHIVE_H
+#define REPORT_ARCHIVE_H
+
+#include <QFile>
+#include <QString>
+
+#include <vector>
+
+#include "DFTime.h"
+
+class AnnouncementTypeList;
+
+// Append-only report file. After a header, it is a sequence of records:
+//  - Type: u8 1, i32 index, u32 length, name
+//  - Report: u8 2, i32 id, i64 time, i32 type index, i32 color, i32 repeat, u32 length, UTF-8 text
+//  - Repeat: u8 3, i32 id, i32 repeat
+//  - Span: u8 4, i32 id, i32 end id (after a report folding continuation lines)
+// All integers are little-endian. Type indices are local to the file,
+// each is defined by the Type record preceding its first use and is
+// never reused. Older files may reuse indices: readers resolve a Type
+// index when reading the record using it.
+class ReportArchive
+{
+public:
+	ReportArchive(const AnnouncementTypeList &type_list);
+	~ReportArchive();
+
+	static QString directory();
+	static QString path(const QString &name);
+
+	// Open the archive for appending reports newer than last_id, the
+	// file is truncated to valid_size (dropping any incomplete record).
+	// type_ids are the AnnouncementTypeList ids of the type indices
+	// already in the file (-1 for unused indices).
+	bool open(const QString &name, qint64 valid_size, int last_id, const std::vector<int> &type_ids);
+	void close();
+	bool isOpen() const { return _file.isOpen(); }
+	const QString &name() const { return _name; }
+
+	// type is an AnnouncementTypeList id
+	void appendReport(int id, int end_id, DF::time time, int type, int color, int repeat, const QString &text);
+	void appendRepeat(int id, int repeat);
+	void flush();
+
+	enum RecordType: quint8 {
+		TypeRecord = 1,
+		ReportRecord = 2,
+		RepeatRecord = 3,
+		SpanRecord = 4,
+	};
+
+	// Decode records from archive data (usually mapped from the file)
+	class Reader
+	{
+	public:
+		Reader(QByteArrayView data = {});
+
+		bool isValid() const { return _valid; }
+		// Continue reading from the record at offset
+		void seek(qsizetype offset) { _next_offset = offset; }
+		// Read the next record, returns false at the end of the data or
+		// on an incomplete record.
+		bool next();
+		// Offset of the current record, or of the end of valid data
+		// after next() returned false.
+		qsizetype offset() const { return _offset; }
+
+		RecordType type() const { return _type; }
+		// Type and report records
+		int typeIndex() const { return _type_index; }
+		// Type record
+		QByteArrayView typeName() const { return _string; }
+		// Report, repeat and span records
+		int id() const { return _id; }
+		static int recordId(QByteArrayView data, qsizetype offset);
+		int repeat() const { return _repeat; }
+		// Span record
+		int endId() const { return _end_id; }
+		// Report record
+		DF::time time() const { return _time; }
+		int color() const { return _color; }
+		QByteArrayView text() const { return _string; }
+
+	private:
+		QByteArrayView _data;
+		qsizetype _offset, _next_offset;
+		bool _valid;
+		RecordType _type;
+		int _type_index;
+		int _id;
+		int _repeat;
+		int _end_id;
+		DF::time _time;
+		int _color;
+		QByteArrayView _string;
+	};
+
+private:
+	const AnnouncementTypeList &_type_list;
+	QString _name;
+	QFile _file;
+	int _last_id;
+	std::vector<int> _type_indices; // file type index of each type id, or -1
+	int _type_count; // next file type index
+};
+
+#endif
@@ -18,26 +18,192 @@
 
 #include "ReportFilterProxyModel.h"
 
+#include <QtConcurrent>
+
+#include <algorithm>
+
 #include "Application.h"
 #include "ReportModel.h"
 
+// Models with fewer rows are filtered on the GUI thread
+static constexpr int ParallelFilterThreshold = 50000;
+static constexpr int ParallelFilterChunkSize = 16384;
+
+ReportFilterProxyModel::Candidates::Candidates(const ReportQuery &query, const TextIndex &text_index):
+	ids(text_index.candidates(query.trigrams())),
+	last_id(text_index.lastId()),
+	generation(text_index.generation())
+{
+}
+
+bool ReportFilterProxyModel::Candidates::mayMatch(int id) const
+{
+	return id > last_id || std::ranges::binary_search(ids, id);
+}
+
+template <typename TypeEnabled>
+bool ReportFilterProxyModel::acceptsReport(const ReportModel::report_columns &reports, int row,
+		TypeEnabled &&type_enabled,
+		const ReportQuery &query,
+		const Candidates *candidates)
+{
+	return type_enabled(reports.type[row])
+		&& (!candidates || candidates->mayMatch(reports.id[row]))
+		&& query.matches(reports, row);
+}
+
 ReportFilterProxyModel::ReportFilterProxyModel(QObject *parent):
 	QSortFilterProxyModel(parent),
-	_type_list(Application::instance()->settings()->announcement_types)
+	_type_list(Application::instance()->settings()->announcement_types),
+	_report_model(nullptr),
+	_refilter_serial(0),
+	_refilter_pending(false)
 {
-	connect(&_type_list, &AnnouncementTypeList::typesChanged, [this]() {
-			invalidateRowsFilter();
+	// Toggling a single type is handled by ReportModel signaling the
+	// rows of that type with FilterRole. A pending parallel result is
+	// outdated though.
+	setFilterRole(ReportModel::FilterRole);
+	connect(&_type_list, &AnnouncementTypeList::typeEnabledChanged, [this]() {
+			if (_refilter_pending)
+				refilter();
 		});
+	connect(&_type_list, &AnnouncementTypeList::typesChanged,
+		this, &ReportFilterProxyModel::refilter);
 }
 
 ReportFilterProxyModel::~ReportFilterProxyModel()
 {
 }
 
+void ReportFilterProxyModel::setSourceModel(QAbstractItemModel *source_model)
+{
+	if (_report_model)
+		disconnect(_report_model, &ReportModel::filterInvalidated,
+			this, &ReportFilterProxyModel::refilter);
+	_report_model = qobject_cast<ReportModel *>(source_model);
+	if (_report_model)
+		connect(_report_model, &ReportModel::filterInvalidated,
+			this, &ReportFilterProxyModel::refilter);
+	++_refilter_serial;
+	_refilter_pending = false;
+	QSortFilterProxyModel::setSourceModel(source_model);
+}
+
 bool ReportFilterProxyModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
 {
-	auto index = sourceModel()->index(source_row, static_cast<int>(ReportModel::Columns::Type), source_parent);
-	return index.isValid()
-		&& _type_list.isTypeEnabled(index.data(Qt::DisplayRole).toByteArray())
-		&& QSortFilterProxyModel::filterAcceptsRow(source_row, source_parent);
+	if (!_report_model || source_parent.isValid())
+		return false;
+	if (!_accepted.empty())
+		return _accepted[source_row];
+	if (!inDateRange(source_row))
+		return false;
+	if (!_query.trigrams().empty()) {
+		// Candidates are computed once per query, and again only if
+		// reports were inserted among the already indexed ones.
+		const auto &text_index = _report_model->textIndex();
+		if (!_candidates || _candidates->generation != text_index.generation())
+			_candidates.emplace(_query, text_index);
+	}
+	return acceptsReport(_report_model->reports(), source_row,
+			[this](int type) { return _type_list.isTypeEnabled(type); },
+			_query, _candidates ? &*_candidates : nullptr);
+}
+
+void ReportFilterProxyModel::setQuery(ReportQuery query)
+{
+	_query = std::move(query);
+	_candidates.reset();
+	refilter();
+}
+
+void ReportFilterProxyModel::setDateRange(std::optional<DF::time> begin, std::optional<DF::time> end)
+{
+	if (begin == _date_begin && end == _date_end)
+		return;
+	_date_begin = begin;
+	_date_end = end;
+	refilter();
+}
+
+std::pair<int, int> ReportFilterProxyModel::dateRows() const
+{
+	return {_date_begin ? _report_model->rowForTime(*_date_begin) : -1,
+		_date_end ? _report_model->rowForTime(*_date_end) : -1};
+}
+
+bool ReportFilterProxyModel::inDateRange(int source_row) const
+{
+	if (_date_rows) {
+		auto [first, last] = *_date_rows;
+		return (first < 0 || source_row >= first) && (last < 0 || source_row < last);
+	}
+	// Rows inserted since the last refilter are checked one by one
+	auto t = _report_model->time(source_row);
+	return (!_date_begin || t >= *_date_begin) && (!_date_end || t < *_date_end);
+}
+
+void ReportFilterProxyModel::refilter()
+{
+	auto serial = ++_refilter_serial;
+	if (!_report_model || _report_model->rowCount({}) < ParallelFilterThreshold) {
+		_refilter_pending = false;
+		if (_report_model)
+			_date_rows = dateRows();
+		invalidateRowsFilter();
+		_date_rows.reset();
+		return;
+	}
+	_refilter_pending = true;
+	// Chunks are filtered over a snapshot of the columns, the result
+	// is dropped if the model or the filter changed in the meantime.
+	// The indices are not shared with the snapshot (the model would
+	// have to copy them on the next insertion), candidates are computed
+	// here. The query is compiled again so that it knows every type in
+	// the snapshot and does not read the type list from the worker
+	// threads.
+	auto [first_row, last_row] = dateRows();
+	auto reports = _report_model->reports();
+	reports.text_index = {};
+	reports.type_ids = {};
+	reports.positions = {};
+	reports.date_index = {};
+	std::optional<Candidates> candidates;
+	if (!_query.trigrams().empty())
+		candidates.emplace(_query, _report_model->textIndex());
+	QtConcurrent::run([reports = std::move(reports),
+			candidates = std::move(candidates),
+			enabled_types = _type_list.enabledTypes(),
+			query = ReportQuery(_query.text()),
+			first_row = std::max(first_row, 0),
+			last_row = last_row < 0 ? _report_model->rowCount({}) : last_row]() {
+		// Rows out of the date range are never tested
+		std::vector<char> accepted(reports.size());
+		std::vector<int> chunks;
+		for (int first = first_row; first < last_row; first += ParallelFilterChunkSize)
+			chunks.push_back(first);
+		QtConcurrent::blockingMap(chunks, [&](int first) {
+			int last = std::min(first + ParallelFilterChunkSize, last_row);
+			for (int row = first; row < last; ++row)
+				accepted[row] = acceptsReport(reports, row,
+						[&enabled_types](int type) {
+							return std::size_t(type) < enabled_types.size()
+								&& enabled_types[type];
+						},
+						query, candidates ? &*candidates : nullptr);
+		});
+		return accepted;
+	}).then(this, [this, serial, revision = _report_model->revision()](QFuture<std::vector<char>> accepted) {
+		if (serial != _refilter_serial)
+			return; // superseded by another refilter
+		if (revision != _report_model->revision()) {
+			refilter();
+			return;
+		}
+		_refilter_pending = false;
+		// filterAcceptsRow reads the result while the filter is
+		// invalidated
+		_accepted = accepted.takeResult();
+		invalidateRowsFilter();
+		_accepted.clear();
+	});
 }
@@ -21,6 +21,12 @@
 
 #include <QSortFilterProxyModel>
 
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "ReportQuery.h"
+
 class AnnouncementTypeList;
 
 class ReportFilterProxyModel: public QSortFilterProxyModel
@@ -30,11 +36,56 @@ public:
 	ReportFilterProxyModel(QObject *parent = nullptr);
 	~ReportFilterProxyModel() override;
 
+	void setSourceModel(QAbstractItemModel *source_model) override;
+
+	const ReportQuery &query() const { return _query; }
+
+	// Only accept reports dated in [begin, end), a missing bound is not
+	// checked. The rows are found from the model date index.
+	void setDateRange(std::optional<DF::time> begin, std::optional<DF::time> end);
+
+public slots:
+	void setQuery(ReportQuery query);
+	// Filter all the rows again, large models are filtered in parallel
+	// and the result is installed when ready.
+	void refilter();
+
 protected:
 	bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const override;
 
 private:
+	// Rows of the date range [first, last), -1 when a bound is not set
+	std::pair<int, int> dateRows() const;
+	bool inDateRange(int source_row) const;
+
+	// Candidate ids from the text index, ids after last_id were added
+	// later and are only matched against the query.
+	struct Candidates {
+		std::vector<int> ids;
+		int last_id;
+		quint64 generation;
+
+		Candidates(const ReportQuery &query, const TextIndex &text_index);
+		bool mayMatch(int id) const;
+	};
+	template <typename TypeEnabled>
+	static bool acceptsReport(const ReportModel::report_columns &reports, int row,
+			TypeEnabled &&type_enabled,
+			const ReportQuery &query,
+			const Candidates *candidates);
+
 	const AnnouncementTypeList &_type_list;
+	const ReportModel *_report_model;
+	ReportQuery _query;
+	std::optional<DF::time> _date_begin, _date_end;
+	// Rows of the date range, only set while the filter is invalidated
+	// (the model is not modified during that time)
+	std::optional<std::pair<int, int>> _date_rows;
+	mutable std::optional<Candidates> _candidates;
+	// Result of a parallel filtering, only set while it is installed
+	std::vector<char> _accepted;
+	quint64 _refilter_serial;
+	bool _refilter_pending;
 };
 
 #endif
@@ -19,20 +19,29 @@
 #include "ReportModel.h"
 
 #include <array>
+#include <limits>
 #include <QColor>
+#include <QtConcurrent>
 
 #include "AnnouncementTypeList.h"
 #include "Application.h"
 
 ReportModel::ReportModel(QObject *parent):
 	QAbstractTableModel(parent),
-	_type_list(Application::instance()->settings()->announcement_types)
+	_type_list(Application::instance()->settings()->announcement_types),
+	_revision(0),
+	_min_id(std::numeric_limits<int>::min()),
+	_archive(_type_list)
 {
 	auto settings = Application::instance()->settings();
-	connect(&settings->color_palette, &QAbstractItemModel::dataChanged, [this]() {
-			int col = static_cast<int>(Columns::Text);
-			dataChanged(index(0, col), index(_reports.size()-1, col), {Qt::ForegroundRole});
-		});
+	connect(&_type_list, &AnnouncementTypeList::typeEnabledChanged,
+		this, &ReportModel::invalidateTypeRows);
+	for (auto property: {
+			&settings->history_max_rows,
+			&settings->history_max_size,
+			&settings->history_max_years})
+		connect(property, &SettingPropertyBase::valueChanged,
+			this, &ReportModel::applyRetentionPolicy);
 }
 
 int ReportModel::rowCount(const QModelIndex &parent) const
@@ -71,40 +80,37 @@ QVariant ReportModel::headerData(int section, Qt::Orientation orientation, int r
 QVariant ReportModel::data(const QModelIndex &index, int role) const
 {
 	auto settings = Application::instance()->settings();
-	const auto &report = _reports[index.row()];
+	int row = index.row();
 	switch (static_cast<Columns>(index.column())) {
 	case Columns::Id:
 		switch (role) {
 		case Qt::DisplayRole:
-			return report.id;
+			return _reports.id[row];
 		default:
 			return {};
 		}
 	case Columns::Date:
 		switch (role) {
 		case Qt::DisplayRole:
-			return DF::prettyDate(report.time);
+			return _date_cache(_reports.time[row]);
 		case SortRole:
-			return static_cast<qlonglong>(report.time.count());
+			return static_cast<qlonglong>(_reports.time[row].count());
 		default:
 			return {};
 		}
 	case Columns::Text:
 		switch (role) {
 		case Qt::DisplayRole:
-			if (report.repeat > 0)
-				return QString("%1 (×%2)").arg(report.text).arg(report.repeat+1);
-			else
-				return report.text;
+			return _reports.display[row];
 		case Qt::ForegroundRole:
-			return settings->color_palette.color(report.color);
+			return settings->color_palette.brush(_reports.color[row]);
 		default:
 			return {};
 		}
 	case Columns::Type:
 		switch (role) {
 		case Qt::DisplayRole:
-			return report.type;
+			return _type_list.typeName(_reports.type[row]);
 		default:
 			return {};
 		}
@@ -113,73 +119,565 @@ QVariant ReportModel::data(const QModelIndex &index, int role) const
 	}
 }
 
-void ReportModel::update(const dfproto::Reports::ReportList &report_list)
+ReportModel::Snapshot ReportModel::snapshot() const
+{
+	auto settings = Application::instance()->settings();
+	// The archive history is older than the game buffer, it is merged
+	// with the live reports instead of being replaced by them.
+	return {_revision, _reports.id, _reports.end_id, _reports.repeat, _type_list.typeIds(),
+		_min_id, settings->history_keep_removed() || _archive.isOpen()};
+}
+
+ReportModel::Changes ReportModel::diff(const Snapshot &snapshot,
+		const dfproto::Reports::ReportList &report_list,
+		std::optional<int> last_id)
 {
-	auto report = _reports.begin();
+	Changes changes = {snapshot.revision, {}, static_cast<int>(snapshot.types.size()), {}};
+	auto types = snapshot.types; // only detached if there are new types
+	const auto &ids = snapshot.ids;
+	auto id = ids.begin();
 	const auto &df_reports = report_list.reports();
-	auto df_report = df_reports.begin();
+	// Reports evicted by the retention policy are not inserted again
+	auto df_begin = std::lower_bound(df_reports.begin(), df_reports.end(), snapshot.min_id,
+			[](const auto &report, int id){return report.id() < id;});
+	// A partial list only starts before last_id if the request was
+	// not sent from that cursor, those reports would be inserted again.
+	if (last_id)
+		df_begin = std::lower_bound(df_begin, df_reports.end(), *last_id,
+				[](const auto &report, int id){return report.id() < id;});
+	// Continuation lines are folded into their head report, the rest
+	// of the diff works on these groups of lines.
+	struct group {
+		int id, end_id;
+		int repeat;
+		int first, count; // lines in df_reports
+	};
+	std::vector<group> groups;
+	for (auto it = df_begin; it != df_reports.end(); ++it) {
+		int index = std::distance(df_reports.begin(), it);
+		if (groups.empty() || !it->continuation())
+			groups.push_back({it->id(), it->id(), it->repeat(), index, 1});
+		else {
+			auto &g = groups.back();
+			g.end_id = it->id();
+			g.repeat = std::max(g.repeat, it->repeat());
+			++g.count;
+		}
+	}
+	// Leading continuation lines whose head is already in the model (the
+	// partial list starts from the last line) are folded into the head
+	// row, only its repeat count may have changed.
+	if (!groups.empty() && df_reports[groups.front().first].continuation()) {
+		auto head = std::upper_bound(ids.begin(), ids.end(), groups.front().id);
+		if (head != ids.begin()) {
+			int row = std::distance(ids.begin(), head) - 1;
+			if (snapshot.end_ids[row] >= groups.front().id) {
+				if (groups.front().repeat > snapshot.repeats[row])
+					changes.operations.push_back(Changes::Update{row, {groups.front().repeat}});
+				groups.erase(groups.begin());
+			}
+		}
+	}
+	// An empty list (new world, or the game buffer was cleared) has no
+	// range to merge, kept reports are never removed.
+	if (groups.empty() && snapshot.keep_removed)
+		return changes;
+	auto df_report = groups.cbegin();
+	// Reports older than first_id are removed from the front, reports
+	// before last_id are kept and the list is merged from there.
+	std::optional<int> first_id;
+	if (last_id) {
+		if (report_list.has_first_id() && !snapshot.keep_removed)
+			first_id = report_list.first_id();
+	}
+	else if (df_report != groups.cend()) {
+		// Fast path for the common case of a complete list: old reports
+		// dropped from the front and new reports appended at the end.
+		// Only the first and last ids of the overlap are compared, and
+		// only the last known report may have its repeat count updated
+		// (the game only increments the latest report).
+		auto front = std::lower_bound(ids.begin(), ids.end(), df_report->id);
+		auto overlap = std::distance(front, ids.end());
+		if (overlap > 0 && overlap <= std::distance(df_report, groups.cend())
+				&& *front == df_report->id
+				&& (df_report + (overlap-1))->id == ids.back()) {
+			if (!snapshot.keep_removed)
+				first_id = *front;
+			last_id = ids.back();
+			df_report += overlap - 1;
+		}
+		else if (snapshot.keep_removed) {
+			// Reports older than the list are kept
+			last_id = df_report->id;
+		}
+	}
+	if (first_id) {
+		auto remove_end = std::lower_bound(ids.begin(), ids.end(), *first_id);
+		if (remove_end != ids.begin()) {
+			changes.operations.push_back(Changes::Remove{0, static_cast<int>(std::distance(ids.begin(), remove_end)) - 1});
+			id = remove_end;
+		}
+	}
+	int row = 0;
+	if (last_id) {
+		auto merge_begin = std::lower_bound(id, ids.end(), *last_id);
+		row = std::distance(id, merge_begin);
+		id = merge_begin;
+	}
 	while (true) {
-		auto [report_equal_end, df_report_equal_end] = std::mismatch(
-				report, _reports.end(),
-				df_report, df_reports.end(),
-				[](const auto &a, const auto &b){return a.id == b.id();});
-		{
-			auto start_index = index(std::distance(_reports.begin(), report), 0);
-			while (report != report_equal_end)
-				(report++)->update(*(df_report++));
-			auto end_index = index(std::distance(_reports.begin(), report), static_cast<int>(Columns::Count)-1);
-			dataChanged(start_index, end_index);
-		}
-		if (report == _reports.end() && df_report == df_reports.end())
+		auto [id_equal_end, df_report_equal_end] = std::mismatch(
+				id, ids.end(),
+				df_report, groups.cend(),
+				[](int a, const group &b){return a == b.id;});
+		// Only reports with a different repeat count are updated,
+		// consecutive rows are grouped in the same operation
+		for (; id != id_equal_end; ++id, ++df_report, ++row) {
+			auto repeat = snapshot.repeats[std::distance(ids.begin(), id)];
+			if (repeat == df_report->repeat)
+				continue;
+			auto update = changes.operations.empty()
+				? nullptr
+				: std::get_if<Changes::Update>(&changes.operations.back());
+			if (!update || update->row + static_cast<int>(update->repeats.size()) != row)
+				update = &std::get<Changes::Update>(changes.operations.emplace_back(Changes::Update{row, {}}));
+			update->repeats.push_back(df_report->repeat);
+		}
+		if (id == ids.end() && df_report == groups.cend())
 			break;
-		if (report == _reports.end() || df_report->id() < report->id) {
-			auto insert_end = report == _reports.end()
-				? df_reports.end()
-				: std::lower_bound(df_report, df_reports.end(), report->id,
-					[](const auto &report, int id){return report.id() < id;});
-			auto row = std::distance(_reports.begin(), report);
-			auto count = std::distance(df_report, insert_end);
-			beginInsertRows({}, row, row + count - 1);
-			report = _reports.insert(report, count, {});
-			for (int i = 0; i < count; ++i) {
-				auto &new_report = *(report++);
-				new_report.init(*(df_report++));
-				_type_list.addType(new_report.type);
+		if (id == ids.end() || df_report->id < *id) {
+			auto insert_end = id == ids.end()
+				? groups.cend()
+				: std::lower_bound(df_report, groups.cend(), *id,
+					[](const group &g, int id){return g.id < id;});
+			// Only reports that are not already in the model are decoded
+			Changes::Insert insert = {row, {}};
+			insert.reports.resize(std::distance(df_report, insert_end));
+			for (auto &new_report: insert.reports) {
+				// Look up the type without copying its name
+				const auto &df_type = df_reports[df_report->first].type();
+				auto it = types.constFind(QByteArray::fromRawData(df_type.data(), df_type.size()));
+				int type_id;
+				if (it != types.constEnd())
+					type_id = *it;
+				else {
+					type_id = types.size();
+					auto name = QByteArray::fromStdString(df_type);
+					types.insert(name, type_id);
+					changes.new_types.push_back(name);
+				}
+				new_report.init(df_reports[df_report->first], type_id);
+				// Lines are joined where the game wrapped them
+				for (int i = 1; i < df_report->count; ++i) {
+					new_report.text.append(u' ');
+					new_report.text.append(QString::fromUtf8(df_reports[df_report->first + i].text()));
+				}
+				// Only the postings are merged on the GUI thread
+				new_report.trigrams = TextIndex::trigrams(new_report.text);
+				new_report.end_id = df_report->end_id;
+				new_report.repeat = df_report->repeat;
+				++df_report;
 			}
+			row += insert.reports.size();
+			changes.operations.push_back(std::move(insert));
+		}
+		else if (df_report == groups.cend() || df_report->id > *id) {
+			auto remove_end = df_report == groups.cend()
+				? ids.end()
+				: std::lower_bound(id, ids.end(), df_report->id);
+			auto count = std::distance(id, remove_end);
+			changes.operations.push_back(Changes::Remove{row, static_cast<int>(row + count - 1)});
+			id = remove_end;
+		}
+	}
+	return changes;
+}
+
+bool ReportModel::apply(Changes &&changes)
+{
+	if (changes.revision != _revision)
+		return false;
+	++_revision;
+	// The type list is not part of the revision, types added since the
+	// snapshot (e.g. by another diff) shift the ids of the new types.
+	std::vector<int> new_type_ids;
+	bool remap_types = false;
+	for (std::size_t i = 0; i < changes.new_types.size(); ++i) {
+		new_type_ids.push_back(_type_list.addType(changes.new_types[i]));
+		remap_types |= new_type_ids.back() != changes.first_new_type + static_cast<int>(i);
+	}
+	if (remap_types) {
+		for (auto &operation: changes.operations) {
+			auto insert = std::get_if<Changes::Insert>(&operation);
+			if (!insert)
+				continue;
+			for (auto &r: insert->reports)
+				if (r.type >= changes.first_new_type)
+					r.type = new_type_ids[r.type - changes.first_new_type];
+		}
+	}
+	for (auto &operation: changes.operations) {
+		if (auto insert = std::get_if<Changes::Insert>(&operation)) {
+			auto count = insert->reports.size();
+			beginInsertRows({}, insert->row, insert->row + count - 1);
+			for (const auto &r: insert->reports)
+				_archive.appendReport(r.id, r.end_id, r.time, r.type, r.color, r.repeat, r.text);
+			_reports.insert(insert->row, std::move(insert->reports));
+			countReports(insert->row, count, 1);
 			endInsertRows();
 		}
-		else if (df_report == df_reports.end() || df_report->id() > report->id) {
-			auto remove_end = df_report == df_reports.end()
-				? _reports.end()
-				: std::lower_bound(report, _reports.end(), df_report->id(),
-					[](const auto &report, int id){return report.id < id;});
-			auto first = std::distance(_reports.begin(), report);
-			auto last = std::distance(_reports.begin(), remove_end) - 1;
-			beginRemoveRows({}, first, last);
-			report = _reports.erase(report, remove_end);
+		else if (auto remove = std::get_if<Changes::Remove>(&operation)) {
+			beginRemoveRows({}, remove->first, remove->last);
+			countReports(remove->first, remove->last - remove->first + 1, -1);
+			_reports.remove(remove->first, remove->last - remove->first + 1);
 			endRemoveRows();
 		}
+		else if (auto update = std::get_if<Changes::Update>(&operation)) {
+			auto count = update->repeats.size();
+			for (std::size_t i = 0; i < count; ++i) {
+				int row = update->row + i;
+				_statistics.add(_reports.type.at(row), _reports.time.at(row),
+						update->repeats[i] - _reports.repeat.at(row));
+				_reports.setRepeat(row, update->repeats[i]);
+				_archive.appendRepeat(_reports.id.at(row), update->repeats[i]);
+			}
+			// The repeat count is only displayed in the text column,
+			// but queries may filter on it.
+			int col = static_cast<int>(Columns::Text);
+			dataChanged(index(update->row, col), index(update->row + count - 1, col), {Qt::DisplayRole, FilterRole});
+		}
 	}
+	_archive.flush();
+	applyRetentionPolicy();
+	_statistics.flush();
+	return true;
+}
+
+bool ReportModel::openArchive(const QString &name)
+{
+	// An existing archive that cannot be read is left untouched (it
+	// would be truncated as if it was empty), the model is not modified.
+	// Only an incomplete record at the end is dropped.
+	QFile file(ReportArchive::path(name));
+	uchar *data = nullptr;
+	if (file.exists()) {
+		if (!file.open(QIODevice::ReadOnly))
+			return false;
+		if (file.size() > 0 && !(data = file.map(0, file.size())))
+			return false;
+		if (data && !ReportArchive::Reader(QByteArrayView(data, file.size())).isValid()) {
+			file.unmap(data);
+			return false; // not an archive, or from another version
+		}
+	}
+	beginResetModel();
+	_statistics.beginReset();
+	_archive.close();
+	_reports.clear();
+	_min_id = std::numeric_limits<int>::min();
+	++_revision;
+	// The file is mapped and decoded in a single pass
+	std::vector<report> reports;
+	qint64 valid_size = 0;
+	std::vector<int> type_ids; // archive type index to type id
+	if (data) {
+		ReportArchive::Reader reader(QByteArrayView(data, file.size()));
+		while (reader.next()) {
+			switch (reader.type()) {
+			case ReportArchive::TypeRecord:
+				if (std::size_t(reader.typeIndex()) >= type_ids.size())
+					type_ids.resize(reader.typeIndex()+1, -1);
+				type_ids[reader.typeIndex()] = _type_list.addType(reader.typeName().toByteArray());
+				break;
+			case ReportArchive::ReportRecord:
+				if (std::size_t(reader.typeIndex()) >= type_ids.size() || type_ids[reader.typeIndex()] < 0)
+					continue; // unknown type, corrupted file
+				reports.push_back({
+					reader.id(),
+					reader.id(),
+					reader.time(),
+					QString::fromUtf8(reader.text()),
+					type_ids[reader.typeIndex()],
+					reader.color(),
+					reader.repeat(),
+					{},
+				});
+				break;
+			case ReportArchive::RepeatRecord: {
+				auto it = std::ranges::lower_bound(reports, reader.id(), std::less<>{}, &report::id);
+				if (it != reports.end() && it->id == reader.id())
+					it->repeat = reader.repeat();
+				break;
+			}
+			case ReportArchive::SpanRecord:
+				// Always follows its report
+				if (!reports.empty() && reports.back().id == reader.id())
+					reports.back().end_id = reader.endId();
+				break;
+			}
+		}
+		valid_size = reader.offset();
+		file.unmap(data);
+	}
+	int last_id = reports.empty() ? 0 : reports.back().id;
+	// Indexing the texts is the slowest part of loading large archives
+	QtConcurrent::blockingMap(reports, [](report &r) {
+		r.trigrams = TextIndex::trigrams(r.text);
+	});
+	_reports.insert(0, std::move(reports));
+	countReports(0, _reports.size(), 1);
+	_statistics.endReset();
+	endResetModel();
+	applyRetentionPolicy();
+	return _archive.open(name, valid_size, last_id, type_ids);
+}
+
+void ReportModel::closeArchive()
+{
+	_archive.close();
+}
+
+void ReportModel::applyRetentionPolicy()
+{
+	auto settings = Application::instance()->settings();
+	int size = _reports.size();
+	if (size == 0)
+		return;
+	// Count the oldest rows exceeding any of the limits
+	int count = 0;
+	if (auto max_rows = settings->history_max_rows(); max_rows > 0 && size > max_rows)
+		count = size - max_rows;
+	if (auto max_size = settings->history_max_size(); max_size > 0) {
+		qint64 max_bytes = qint64(max_size) * 1024 * 1024;
+		qint64 bytes = _reports.bytes;
+		for (int i = 0; i < count; ++i)
+			bytes -= _reports.rowBytes(i);
+		while (count < size && bytes > max_bytes)
+			bytes -= _reports.rowBytes(count++);
+	}
+	if (auto max_years = settings->history_max_years(); max_years > 0) {
+		// Reports are almost sorted by time, stop at the first recent one
+		auto oldest = _reports.time.constLast() - DF::year(max_years);
+		while (count < size && _reports.time.at(count) < oldest)
+			++count;
+	}
+	if (count == 0)
+		return;
+	// Rows are always evicted from the front, in a single removal
+	beginRemoveRows({}, 0, count - 1);
+	_min_id = _reports.end_id.at(count - 1) + 1;
+	countReports(0, count, -1);
+	_reports.remove(0, count);
+	++_revision;
+	endRemoveRows();
+	_statistics.flush();
+}
+
+void ReportModel::invalidateTypeRows(int type)
+{
+	// Scattered rows are left to the filter as a whole, so that the
+	// proxy does not update its mapping for each of them and can test
+	// them in parallel.
+	static constexpr std::size_t MaxRanges = 256;
+	if (type >= _reports.type_ids.size() || _reports.type_ids.at(type).isEmpty())
+		return;
+	const auto &type_ids = _reports.type_ids.at(type);
+	const auto &ids = _reports.id;
+	std::vector<std::pair<int, int>> ranges;
+	auto row = ids.begin();
+	for (int id: type_ids) {
+		// Rows of the same type are often consecutive
+		if (!ranges.empty() && row != ids.end() && *row == id)
+			++ranges.back().second;
+		else {
+			row = std::lower_bound(row, ids.end(), id);
+			if (row == ids.end() || *row != id)
+				continue;
+			int r = std::distance(ids.begin(), row);
+			ranges.emplace_back(r, r);
+			if (ranges.size() > MaxRanges)
+				break;
+		}
+		++row;
+	}
+	if (ranges.size() > MaxRanges) {
+		filterInvalidated();
+		return;
+	}
+	int col = static_cast<int>(Columns::Id);
+	for (auto [first, last]: ranges)
+		dataChanged(index(first, col), index(last, col), {FilterRole});
 }
 
 void ReportModel::clear()
 {
 	beginResetModel();
+	_statistics.beginReset();
 	_reports.clear();
+	_min_id = std::numeric_limits<int>::min();
+	++_revision;
+	_statistics.endReset();
 	endResetModel();
 }
 
-void ReportModel::report::init(const dfproto::Reports::Report &df_report)
+void ReportModel::countReports(int first, int count, int sign)
+{
+	for (int row = first; row < first + count; ++row)
+		_statistics.add(_reports.type.at(row), _reports.time.at(row),
+				sign * (_reports.repeat.at(row) + 1));
+}
+
+QString ReportModel::displayText(const QString &text, int repeat)
+{
+	if (repeat == 0)
+		return text;
+	QString display;
+	display.reserve(text.size() + 16);
+	display.append(text);
+	display.append(QStringView(u" (×"));
+	display.append(QString::number(repeat+1));
+	display.append(QChar(u')'));
+	return display;
+}
+
+void ReportModel::report::init(const dfproto::Reports::Report &df_report, int type_id)
 {
 	id = df_report.id();
+	end_id = id;
 	time = DF::tick(df_report.time()) + DF::year(df_report.year());
 	text = QString::fromUtf8(df_report.text());
-	type = QByteArray::fromStdString(df_report.type());
+	type = type_id;
 	color = df_report.color() + (df_report.bright() ? 8 : 0);
 	repeat = df_report.repeat();
 }
 
-void ReportModel::report::update(const dfproto::Reports::Report &df_report)
+void ReportModel::report_columns::insert(int row, std::vector<report> &&reports)
 {
-	repeat = df_report.repeat();
+	int count = reports.size();
+	forEachColumn([row, count](auto &column) {
+		column.insert(row, count, {});
+	});
+	for (int i = 0; i < count; ++i) {
+		auto &report = reports[i];
+		text_index.insert(report.id, report.trigrams);
+		if (report.type >= type_ids.size())
+			type_ids.resize(report.type + 1);
+		auto &ids = type_ids[report.type];
+		if (ids.isEmpty() || ids.back() < report.id)
+			ids.append(report.id);
+		else
+			ids.insert(std::lower_bound(ids.begin(), ids.end(), report.id), report.id);
+		id[row+i] = report.id;
+		end_id[row+i] = report.end_id;
+		time[row+i] = report.time;
+		type[row+i] = report.type;
+		color[row+i] = report.color;
+		repeat[row+i] = report.repeat;
+		display[row+i] = displayText(report.text, report.repeat);
+		index_entries[row+i] = report.trigrams.size();
+		text[row+i] = std::move(report.text);
+		bytes += rowBytes(row+i);
+	}
+	// Rows after the inserted ones moved, appending is the common case
+	updatePositions(row);
+	if (row + count == size()) {
+		for (int i = row; i < size(); ++i)
+			date_index.append(position_base + i, time.at(i));
+	}
+	else
+		rebuildDateIndex();
+}
+
+void ReportModel::report_columns::updatePositions(int first_row)
+{
+	for (int row = first_row; row < size(); ++row)
+		positions.insert(id.at(row), position_base + row);
+}
+
+void ReportModel::report_columns::rebuildDateIndex()
+{
+	date_index.clear();
+	for (int row = 0; row < size(); ++row)
+		date_index.append(position_base + row, time.at(row));
+}
+
+int ReportModel::report_columns::row(int report_id) const
+{
+	auto it = positions.constFind(report_id);
+	if (it != positions.constEnd())
+		return *it - position_base;
+	// Continuation lines are only found in the span of their report
+	auto head = std::upper_bound(id.begin(), id.end(), report_id);
+	if (head == id.begin())
+		return -1;
+	int r = std::distance(id.begin(), head) - 1;
+	return end_id.at(r) >= report_id ? r : -1;
+}
+
+int ReportModel::report_columns::rowAtTime(DF::time t) const
+{
+	auto month = date_index.find(t);
+	if (!month)
+		return size();
+	auto [begin, end] = *month;
+	auto first = time.begin() + std::max<qint64>(0, begin - position_base);
+	auto last = end ? time.begin() + std::max<qint64>(0, *end - position_base) : time.end();
+	return std::distance(time.begin(), std::lower_bound(first, last, t));
+}
+
+void ReportModel::report_columns::setRepeat(int row, int value)
+{
+	bytes -= rowBytes(row);
+	repeat[row] = value;
+	display[row] = displayText(text.at(row), value);
+	bytes += rowBytes(row);
+}
+
+void ReportModel::report_columns::remove(int first, int count)
+{
+	// Removed ids are a contiguous range in each type list
+	std::vector<bool> removed_types;
+	for (int i = first; i < first + count; ++i) {
+		bytes -= rowBytes(i);
+		text_index.remove(index_entries.at(i));
+		positions.remove(id.at(i));
+		if (std::size_t(type.at(i)) >= removed_types.size())
+			removed_types.resize(type.at(i) + 1);
+		removed_types[type.at(i)] = true;
+	}
+	if (count > 0) {
+		int first_id = id.at(first), last_id = id.at(first + count - 1);
+		for (std::size_t t = 0; t < removed_types.size(); ++t) {
+			if (!removed_types[t])
+				continue;
+			auto &ids = type_ids[t];
+			ids.erase(std::lower_bound(ids.begin(), ids.end(), first_id),
+					std::upper_bound(ids.begin(), ids.end(), last_id));
+		}
+	}
+	forEachColumn([first, count](auto &column) {
+		column.remove(first, count);
+	});
+	text_index.compact(id);
+	// Removing from the front only moves the base position
+	if (first == 0) {
+		position_base += count;
+		date_index.removeBefore(position_base);
+	}
+	else {
+		updatePositions(first);
+		rebuildDateIndex();
+	}
+}
+
+void ReportModel::report_columns::clear()
+{
+	bytes = 0;
+	text_index.clear();
+	type_ids.clear();
+	positions.clear();
+	position_base = 0;
+	date_index.clear();
+	forEachColumn([](auto &column) {
+		column.clear();
+	});
 }
@@ -20,17 +20,37 @@
 #define REPORT_MODEL_H
 
 #include <QAbstractTableModel>
+#include <QHash>
+#include <QList>
 
+#include <optional>
+#include <variant>
 #include <vector>
 
 #include "reports.pb.h"
 #include "DFTime.h"
+#include "DateIndex.h"
+#include "ReportArchive.h"
+#include "ReportStatisticsModel.h"
+#include "TextIndex.h"
 
 class AnnouncementTypeList;
 
 class ReportModel: public QAbstractTableModel
 {
 	Q_OBJECT
+	struct report {
+		int id;
+		int end_id; // id of the last continuation line
+		DF::time time;
+		QString text;
+		int type; // id from AnnouncementTypeList
+		int color;
+		int repeat;
+		std::vector<TextIndex::Trigram> trigrams; // of text, computed with it
+
+		void init(const dfproto::Reports::Report &report, int type_id);
+	};
 public:
 	ReportModel(QObject *parent = nullptr);
 	~ReportModel() override = default;
@@ -45,6 +65,8 @@ public:
 
 	enum ItemDataRoles {
 		SortRole = Qt::UserRole,
+		// Only used in dataChanged: the filter must test the rows again
+		FilterRole,
 	};
 
 	int rowCount(const QModelIndex &parent) const override;
@@ -52,24 +74,155 @@ public:
 	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
 	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
 
+	int reportId(int row) const { return _reports.id[row]; }
+	// Row of the report with this id (or containing this continuation
+	// line), -1 if it is not in the model
+	int rowForId(int id) const { return _reports.row(id); }
+	DF::time time(int row) const { return _reports.time[row]; }
+	int typeId(int row) const { return _reports.type[row]; }
+	int repeat(int row) const { return _reports.repeat[row]; }
+	// Report text without the repeat count
+	const QString &text(int row) const { return _reports.text[row]; }
+	const TextIndex &textIndex() const { return _reports.text_index; }
+	// First row dated at or after t (rowCount if there is none)
+	int rowForTime(DF::time t) const { return _reports.rowAtTime(t); }
+
+	// Reports are stored by column so that scans only walk the values
+	// they need. QList columns are implicitly shared (copies are cheap
+	// read-only snapshots) and removing rows from the front does not
+	// move the others.
+	struct report_columns {
+		QList<int> id;
+		QList<int> end_id; // reports span the ids of their continuation lines
+		QList<DF::time> time;
+		QList<int> type;
+		QList<int> color;
+		QList<int> repeat;
+		QList<QString> text;
+		QList<QString> display; // text with the repeat count (shares text if not repeated)
+		QList<int> index_entries; // number of trigrams inserted in text_index
+		qint64 bytes = 0; // approximate memory used by the reports (sum of rowBytes)
+		TextIndex text_index;
+		QList<QList<int>> type_ids; // sorted report ids for each type
+		// Position of each report id, its row is position - position_base
+		QHash<int, qint64> positions;
+		qint64 position_base = 0;
+		DateIndex date_index; // uses positions like the hash
+
+		static constexpr qint64 RowSize = 6*sizeof(int) + sizeof(DF::time) + 2*sizeof(QString);
+		// Approximate overheads: a node and bucket in positions, the id
+		// in type_ids and the allocation header of a string
+		static constexpr qint64 IndexRowSize = 32 + sizeof(int);
+		static constexpr qint64 StringDataSize = 32;
+		// Memory used by a row in the columns and the indices, including
+		// its trigram postings and the display text of repeated reports
+		qint64 rowBytes(int row) const {
+			return RowSize + IndexRowSize
+				+ StringDataSize + text[row].size() * sizeof(QChar)
+				+ (repeat[row] != 0 ? StringDataSize + display[row].size() * sizeof(QChar) : 0)
+				+ index_entries[row] * sizeof(int);
+		}
+
+		int size() const { return id.size(); }
+		void insert(int row, std::vector<report> &&reports);
+		void setRepeat(int row, int value);
+		void remove(int first, int count);
+		void clear();
+		void updatePositions(int first_row);
+		void rebuildDateIndex();
+		// Row of the report containing report_id, or -1
+		int row(int report_id) const;
+		// First row dated at or after t, assuming the reports are
+		// almost sorted by date
+		int rowAtTime(DF::time t) const;
+
+		template <typename F>
+		void forEachColumn(F &&f) {
+			f(id); f(end_id); f(time); f(type); f(color); f(repeat); f(text); f(display); f(index_entries);
+		}
+	};
+	const report_columns &reports() const { return _reports; }
+	// Text displayed for a report repeated repeat times
+	static QString displayText(const QString &text, int repeat);
+	// Incremented each time reports are inserted, removed or updated
+	quint64 revision() const { return _revision; }
+	// Counts of the reports in this model by type and season
+	ReportStatisticsModel *statistics() { return &_statistics; }
+
+	// State of the model the changes are computed from (implicitly
+	// shared, taking a snapshot does not copy the reports)
+	struct Snapshot {
+		quint64 revision;
+		QList<int> ids;
+		QList<int> end_ids;
+		QList<int> repeats;
+		QHash<QByteArray, int> types;
+		int min_id; // older reports were evicted and must not be added again
+		bool keep_removed; // keep reports removed from the game
+	};
+	Snapshot snapshot() const;
+
+	// Edit script transforming a snapshot into the new report list,
+	// rows are relative to the model after the previous operations
+	struct Changes {
+		struct Insert {
+			int row;
+			std::vector<report> reports;
+		};
+		struct Remove {
+			int first, last;
+		};
+		struct Update { // only rows whose values actually changed
+			int row;
+			std::vector<int> repeats;
+		};
+		quint64 revision;
+		std::vector<std::variant<Insert, Remove, Update>> operations;
+		// Types to add before applying the operations, the reports
+		// already use the ids AnnouncementTypeList will give them.
+		int first_new_type;
+		std::vector<QByteArray> new_types;
+	};
+	// Compute changes from a complete report list, or a partial list
+	// starting from last_id. Can be called from any thread.
+	static Changes diff(const Snapshot &snapshot,
+			const dfproto::Reports::ReportList &report_list,
+			std::optional<int> last_id = {});
+	// Returns false if the model was modified since the snapshot
+	bool apply(Changes &&changes);
+
+	// Replace the reports with the content of the archive and append
+	// new reports to it.
+	bool openArchive(const QString &name);
+	void closeArchive();
+	bool hasArchive() const { return _archive.isOpen(); }
+	const QString &archiveName() const { return _archive.name(); }
+
+signals:
+	// Every row must be filtered again (instead of a dataChanged with
+	// FilterRole over the whole model)
+	void filterInvalidated();
+
 public slots:
-	void update(const dfproto::Reports::ReportList &report_list);
 	void clear();
+	// Signal the rows of a type as changed for FilterRole, or emit
+	// filterInvalidated if they are too scattered
+	void invalidateTypeRows(int type);
+	// Evict the oldest reports exceeding the history limits from Settings
+	void applyRetentionPolicy();
 
 private:
-	AnnouncementTypeList &_type_list;
-	struct report {
-		int id;
-		DF::time time;
-		QString text;
-		QByteArray type;
-		int color;
-		int repeat;
+	// Add the count of the rows (with their repeats) to the statistics,
+	// sign is -1 for removing them
+	void countReports(int first, int count, int sign);
 
-		void init(const dfproto::Reports::Report &report);
-		void update(const dfproto::Reports::Report &report);
-	};
-	std::vector<report> _reports;
+	AnnouncementTypeList &_type_list;
+	report_columns _reports;
+	quint64 _revision;
+	int _min_id;
+	ReportArchive _archive;
+	DF::PrettyDateCache _date_cache;
+	ReportStatisticsModel _statistics;
 };
 
 #endif
@@ -0,0 +1,346 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ReportQuery.h"
+
+#include <QRegularExpression>
+
+#include <algorithm>
+#include <iterator>
+#include <optional>
+
+#include "AnnouncementTypeList.h"
+#include "Application.h"
+#include "SubstringMatcher.h"
+
+namespace {
+
+struct Node {
+	ReportQuery::Predicate predicate;
+	std::vector<TextIndex::Trigram> trigrams;
+};
+
+enum class Op {
+	Equal,
+	NotEqual,
+	Less,
+	LessEqual,
+	Greater,
+	GreaterEqual,
+};
+
+template <typename T>
+bool compare(Op op, T a, T b)
+{
+	switch (op) {
+	case Op::Equal: return a == b;
+	case Op::NotEqual: return a != b;
+	case Op::Less: return a < b;
+	case Op::LessEqual: return a <= b;
+	case Op::Greater: return a > b;
+	case Op::GreaterEqual: return a >= b;
+	}
+	return false;
+}
+
+bool isWildcard(QStringView value)
+{
+	return std::ranges::any_of(value, [](QChar c) {
+			return c == u'*' || c == u'?' || c == u'[' || c == u'\\';
+		});
+}
+
+// Case-insensitive "contains" match, using a regular expression only for
+// wildcard patterns
+std::function<bool(const QString &)> containsMatcher(const QString &value)
+{
+	if (isWildcard(value)) {
+		QRegularExpression re(
+				QRegularExpression::wildcardToRegularExpression(value,
+					QRegularExpression::UnanchoredWildcardConversion),
+				QRegularExpression::CaseInsensitiveOption);
+		return [re](const QString &text) { return re.match(text).hasMatch(); };
+	}
+	else
+		return [matcher = SubstringMatcher(value)](const QString &text) { return matcher.matches(text); };
+}
+
+class Parser
+{
+public:
+	Parser(QStringView query): _query(query), _pos(0) {}
+
+	std::optional<Node> parse() {
+		skipSpaces();
+		if (_pos == _query.size())
+			return Node{};
+		auto node = parseOr();
+		if (node && _pos < _query.size())
+			return error(ReportQuery::tr("Unexpected \"%1\"").arg(_query.sliced(_pos)));
+		return node;
+	}
+
+	QString error_string;
+
+private:
+	QStringView _query;
+	qsizetype _pos;
+
+	std::nullopt_t error(const QString &message) {
+		if (error_string.isEmpty())
+			error_string = message;
+		return std::nullopt;
+	}
+
+	bool atEnd() const { return _pos == _query.size(); }
+	QChar peek() const { return atEnd() ? QChar() : _query[_pos]; }
+
+	void skipSpaces() {
+		while (!atEnd() && peek().isSpace())
+			++_pos;
+	}
+
+	static bool isSeparator(QChar c) {
+		return c.isNull() || c.isSpace() || c == u'(' || c == u')';
+	}
+
+	// Keywords are upper case so lower case words can still be searched
+	bool peekKeyword(QStringView keyword) const {
+		if (!_query.sliced(_pos).startsWith(keyword))
+			return false;
+		auto end = _pos + keyword.size();
+		return end == _query.size() || isSeparator(_query[end]);
+	}
+
+	bool acceptKeyword(QStringView keyword) {
+		if (!peekKeyword(keyword))
+			return false;
+		_pos += keyword.size();
+		skipSpaces();
+		return true;
+	}
+
+	std::optional<Node> parseOr() {
+		auto left = parseAnd();
+		while (left && acceptKeyword(u"OR")) {
+			auto right = parseAnd();
+			if (!right)
+				return right;
+			// Only trigrams required by both sides are required
+			std::vector<TextIndex::Trigram> trigrams;
+			std::ranges::set_intersection(left->trigrams, right->trigrams, std::back_inserter(trigrams));
+			left = Node{[a = std::move(left->predicate), b = std::move(right->predicate)]
+					(const ReportModel::report_columns &reports, int row) {
+						return a(reports, row) || b(reports, row);
+					}, std::move(trigrams)};
+		}
+		return left;
+	}
+
+	std::optional<Node> parseAnd() {
+		auto left = parseUnary();
+		while (left && !atEnd() && peek() != u')' && !peekKeyword(u"OR")) {
+			acceptKeyword(u"AND");
+			auto right = parseUnary();
+			if (!right)
+				return right;
+			std::vector<TextIndex::Trigram> trigrams;
+			std::ranges::set_union(left->trigrams, right->trigrams, std::back_inserter(trigrams));
+			left = Node{[a = std::move(left->predicate), b = std::move(right->predicate)]
+					(const ReportModel::report_columns &reports, int row) {
+						return a(reports, row) && b(reports, row);
+					}, std::move(trigrams)};
+		}
+		return left;
+	}
+
+	std::optional<Node> parseUnary() {
+		if (atEnd())
+			return error(ReportQuery::tr("Unexpected end of query"));
+		if (acceptKeyword(u"NOT")) {
+			auto node = parseUnary();
+			if (!node)
+				return node;
+			return Node{[a = std::move(node->predicate)](const ReportModel::report_columns &reports, int row) {
+					return !a(reports, row);
+				}, {}};
+		}
+		if (peek() == u'(') {
+			++_pos;
+			skipSpaces();
+			auto node = parseOr();
+			if (!node)
+				return node;
+			if (peek() != u')')
+				return error(ReportQuery::tr("Missing \")\""));
+			++_pos;
+			skipSpaces();
+			return node;
+		}
+		auto node = parseTerm();
+		skipSpaces();
+		return node;
+	}
+
+	std::optional<Op> parseOp() {
+		static constexpr std::pair<QStringView, Op> Ops[] = {
+			{u":", Op::Equal},
+			{u"!=", Op::NotEqual},
+			{u"<=", Op::LessEqual},
+			{u">=", Op::GreaterEqual},
+			{u"=", Op::Equal},
+			{u"<", Op::Less},
+			{u">", Op::Greater},
+		};
+		for (const auto &[str, op]: Ops) {
+			if (_query.sliced(_pos).startsWith(str)) {
+				_pos += str.size();
+				return op;
+			}
+		}
+		return std::nullopt;
+	}
+
+	std::optional<QString> parseValue() {
+		if (peek() == u'"') {
+			auto end = _query.indexOf(u'"', _pos+1);
+			if (end == -1)
+				return error(ReportQuery::tr("Missing closing quote"));
+			auto value = _query.sliced(_pos+1, end-_pos-1).toString();
+			_pos = end+1;
+			return value;
+		}
+		auto begin = _pos;
+		while (!isSeparator(peek()))
+			++_pos;
+		if (_pos == begin)
+			return error(ReportQuery::tr("Missing value"));
+		return _query.sliced(begin, _pos-begin).toString();
+	}
+
+	std::optional<Node> parseTerm() {
+		auto begin = _pos;
+		while (!atEnd() && peek().isLetter())
+			++_pos;
+		auto field = _query.sliced(begin, _pos-begin).toString().toLower();
+		std::optional<Op> op;
+		if (!field.isEmpty())
+			op = parseOp();
+		if (!op) {
+			// Plain text
+			_pos = begin;
+			auto value = parseValue();
+			if (!value)
+				return std::nullopt;
+			return textNode(Op::Equal, *value);
+		}
+		auto value = parseValue();
+		if (!value)
+			return std::nullopt;
+		if (field == u"text")
+			return textNode(*op, *value);
+		else if (field == u"type")
+			return typeNode(*op, *value);
+		else if (field == u"date")
+			return dateNode(*op, *value);
+		else if (field == u"repeat")
+			return numberNode(*op, *value, [](const ReportModel::report_columns &reports, int row) {
+					return reports.repeat[row] + 1;
+				});
+		else if (field == u"id")
+			return numberNode(*op, *value, [](const ReportModel::report_columns &reports, int row) {
+					return reports.id[row];
+				});
+		else
+			return error(ReportQuery::tr("Unknown field \"%1\"").arg(field));
+	}
+
+	std::optional<Node> textNode(Op op, const QString &value) {
+		if (op != Op::Equal && op != Op::NotEqual)
+			return error(ReportQuery::tr("Text only supports \":\", \"=\" and \"!=\""));
+		auto match = containsMatcher(value);
+		bool negate = op == Op::NotEqual;
+		return Node{[match, negate](const ReportModel::report_columns &reports, int row) {
+				return match(reports.text[row]) != negate;
+			}, negate ? std::vector<TextIndex::Trigram>{} : TextIndex::wildcardTrigrams(value)};
+	}
+
+	std::optional<Node> typeNode(Op op, const QString &value) {
+		if (op != Op::Equal && op != Op::NotEqual)
+			return error(ReportQuery::tr("Type only supports \":\", \"=\" and \"!=\""));
+		const auto &type_list = Application::instance()->settings()->announcement_types;
+		auto match = containsMatcher(value);
+		bool negate = op == Op::NotEqual;
+		// Known types are matched once, types added later are matched
+		// by name.
+		std::vector<bool> known(type_list.typeIds().size());
+		for (std::size_t i = 0; i < known.size(); ++i)
+			known[i] = match(QString::fromLatin1(type_list.typeName(i))) != negate;
+		return Node{[&type_list, known = std::move(known), match, negate](const ReportModel::report_columns &reports, int row) {
+				auto type = reports.type[row];
+				if (std::size_t(type) < known.size())
+					return bool(known[type]);
+				else
+					return match(QString::fromLatin1(type_list.typeName(type))) != negate;
+			}, {}};
+	}
+
+	template <typename F>
+	std::optional<Node> numberNode(Op op, const QString &value, F &&field) {
+		bool ok;
+		int n = value.toInt(&ok);
+		if (!ok)
+			return error(ReportQuery::tr("Invalid number \"%1\"").arg(value));
+		return Node{[op, n, field = std::forward<F>(field)](const ReportModel::report_columns &reports, int row) {
+				return compare(op, field(reports, row), n);
+			}, {}};
+	}
+
+	std::optional<Node> dateNode(Op op, const QString &value) {
+		auto range = DF::parseDateRange(value);
+		if (!range)
+			return error(ReportQuery::tr("Invalid date \"%1\"").arg(value));
+		DF::time begin = range->first, end = range->second;
+		return Node{[op, begin, end](const ReportModel::report_columns &reports, int row) {
+				auto time = reports.time[row];
+				switch (op) {
+				case Op::Equal: return time >= begin && time < end;
+				case Op::NotEqual: return time < begin || time >= end;
+				case Op::Less: return time < begin;
+				case Op::LessEqual: return time < end;
+				case Op::Greater: return time >= end;
+				case Op::GreaterEqual: return time >= begin;
+				}
+				return false;
+			}, {}};
+	}
+};
+
+}
+
+ReportQuery::ReportQuery(const QString &query):
+	_text(query)
+{
+	Parser parser(query);
+	if (auto node = parser.parse()) {
+		_predicate = std::move(node->predicate);
+		_trigrams = std::move(node->trigrams);
+	}
+	else
+		_error = parser.error_string;
+}
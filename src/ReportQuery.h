@@ -0,0 +1,67 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef REPORT_QUERY_H
+#define REPORT_QUERY_H
+
+#include <QCoreApplication>
+#include <QString>
+
+#include <functional>
+#include <vector>
+
+#include "ReportModel.h"
+
+// Filter query, terms are implicitly combined with AND:
+//   word or "quoted words"   text contains (wildcards allowed)
+//   text:value               same as above
+//   type:value               type name contains (wildcards allowed)
+//   date<op>YEAR[-MONTH[-DAY]]  MONTH is a name or a number
+//   repeat<op>N              repeat count as displayed (1 if not repeated)
+//   id<op>N
+// with <op> one of : = != < <= > >=, terms can be combined with AND, OR,
+// NOT and parentheses. The query is compiled once into a predicate
+// reading ReportModel columns directly (or a snapshot of them).
+class ReportQuery
+{
+	Q_DECLARE_TR_FUNCTIONS(ReportQuery)
+public:
+	ReportQuery(const QString &query = {});
+
+	const QString &text() const { return _text; }
+	bool isEmpty() const { return !_predicate; }
+	bool isValid() const { return _error.isEmpty(); }
+	const QString &errorString() const { return _error; }
+
+	// Can be called from any thread
+	bool matches(const ReportModel::report_columns &reports, int row) const {
+		return !_predicate || _predicate(reports, row);
+	}
+	// Trigrams contained in the text of every matching report
+	const std::vector<TextIndex::Trigram> &trigrams() const { return _trigrams; }
+
+	using Predicate = std::function<bool(const ReportModel::report_columns &, int)>;
+
+private:
+	QString _text;
+	Predicate _predicate;
+	std::vector<TextIndex::Trigram> _trigrams;
+	QString _error;
+};
+
+#endif
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ReportStatisticsModel.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "AnnouncementTypeList.h"
+#include "Application.h"
+
+ReportStatisticsModel::ReportStatisticsModel(QObject *parent):
+	QAbstractTableModel(parent),
+	_type_list(Application::instance()->settings()->announcement_types),
+	_resetting(false),
+	_first_changed_row(std::numeric_limits<int>::max()),
+	_last_changed_row(-1),
+	_last_changed_season(-1)
+{
+}
+
+ReportStatisticsModel::~ReportStatisticsModel()
+{
+}
+
+int ReportStatisticsModel::rowCount(const QModelIndex &parent) const
+{
+	if (parent.isValid())
+		return 0;
+	else
+		return _row_types.size();
+}
+
+int ReportStatisticsModel::columnCount(const QModelIndex &parent) const
+{
+	if (parent.isValid())
+		return 0;
+	else
+		return static_cast<int>(Columns::FirstSeason) + _seasons.size();
+}
+
+QVariant ReportStatisticsModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+	if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+		return {};
+	switch (static_cast<Columns>(section)) {
+	case Columns::Type:
+		return tr("Type");
+	case Columns::Total:
+		return tr("Total");
+	default: {
+		int season = _seasons[section - static_cast<int>(Columns::FirstSeason)];
+		return QString("%1 %2")
+			.arg(DF::Seasons[season % int(DF::Seasons.size())])
+			.arg(season / int(DF::Seasons.size()));
+	}
+	}
+}
+
+QVariant ReportStatisticsModel::data(const QModelIndex &index, int role) const
+{
+	int row = index.row();
+	auto column = static_cast<Columns>(index.column());
+	switch (role) {
+	case Qt::DisplayRole:
+		switch (column) {
+		case Columns::Type:
+			return _type_list.typeName(_row_types[row]);
+		case Columns::Total:
+			return _type_totals[row];
+		default: {
+			int count = _counts[row][index.column() - static_cast<int>(Columns::FirstSeason)];
+			return count == 0 ? QVariant() : QVariant(count);
+		}
+		}
+	case Qt::TextAlignmentRole:
+		if (column == Columns::Type)
+			return {};
+		return QVariant::fromValue(Qt::Alignment(Qt::AlignRight | Qt::AlignVCenter));
+	default:
+		return {};
+	}
+}
+
+void ReportStatisticsModel::add(int type, DF::time time, int count)
+{
+	if (count == 0)
+		return;
+	int r = row(type);
+	int c = column(std::chrono::floor<DF::season>(time).count());
+	_counts[r][c] += count;
+	_type_totals[r] += count;
+	_season_totals[c] += count;
+	_first_changed_row = std::min(_first_changed_row, r);
+	_last_changed_row = std::max(_last_changed_row, r);
+	_last_changed_season = std::max(_last_changed_season, c);
+}
+
+void ReportStatisticsModel::flush()
+{
+	if (_last_changed_row >= 0) {
+		int first_season = static_cast<int>(Columns::FirstSeason);
+		dataChanged(index(_first_changed_row, static_cast<int>(Columns::Total)),
+				index(_last_changed_row, first_season + _last_changed_season),
+				{Qt::DisplayRole});
+		_first_changed_row = std::numeric_limits<int>::max();
+		_last_changed_row = -1;
+		_last_changed_season = -1;
+	}
+	// Evicted reports empty the oldest seasons
+	for (int c = _seasons.size()-1; c >= 0; --c) {
+		if (_season_totals[c] != 0)
+			continue;
+		int column = static_cast<int>(Columns::FirstSeason) + c;
+		beginRemoveColumns({}, column, column);
+		_seasons.remove(c);
+		_season_totals.remove(c);
+		for (auto &counts: _counts)
+			counts.remove(c);
+		endRemoveColumns();
+	}
+}
+
+void ReportStatisticsModel::beginReset()
+{
+	beginResetModel();
+	_resetting = true;
+	_row_types.clear();
+	_type_rows.clear();
+	_seasons.clear();
+	_counts.clear();
+	_type_totals.clear();
+	_season_totals.clear();
+}
+
+void ReportStatisticsModel::endReset()
+{
+	_resetting = false;
+	_first_changed_row = std::numeric_limits<int>::max();
+	_last_changed_row = -1;
+	_last_changed_season = -1;
+	endResetModel();
+}
+
+int ReportStatisticsModel::row(int type)
+{
+	if (type < _type_rows.size() && _type_rows[type] >= 0)
+		return _type_rows[type];
+	// Types are listed in the order they are first reported
+	int r = _row_types.size();
+	if (!_resetting)
+		beginInsertRows({}, r, r);
+	if (type >= _type_rows.size())
+		_type_rows.resize(type + 1, -1);
+	_type_rows[type] = r;
+	_row_types.append(type);
+	_counts.append(QList<int>(_seasons.size(), 0));
+	_type_totals.append(0);
+	if (!_resetting)
+		endInsertRows();
+	return r;
+}
+
+int ReportStatisticsModel::column(int season)
+{
+	// New reports are usually from the latest season
+	if (!_seasons.isEmpty() && _seasons.back() == season)
+		return _seasons.size()-1;
+	auto it = std::lower_bound(_seasons.begin(), _seasons.end(), season);
+	int c = std::distance(_seasons.begin(), it);
+	if (it != _seasons.end() && *it == season)
+		return c;
+	int column = static_cast<int>(Columns::FirstSeason) + c;
+	if (!_resetting)
+		beginInsertColumns({}, column, column);
+	_seasons.insert(c, season);
+	_season_totals.insert(c, 0);
+	for (auto &counts: _counts)
+		counts.insert(c, 0);
+	if (!_resetting)
+		endInsertColumns();
+	if (c <= _last_changed_season)
+		++_last_changed_season;
+	return c;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef REPORT_STATISTICS_MODEL_H
+#define REPORT_STATISTICS_MODEL_H
+
+#include <QAbstractTableModel>
+#include <QList>
+
+#include "DFTime.h"
+
+class AnnouncementTypeList;
+
+// Number of reports (counting repeats) of each type for each season.
+// Counts are adjusted by ReportModel as reports are inserted, removed or
+// repeated. The changes are signaled by flush with a single dataChanged,
+// whatever the number of reports.
+class ReportStatisticsModel: public QAbstractTableModel
+{
+	Q_OBJECT
+public:
+	ReportStatisticsModel(QObject *parent = nullptr);
+	~ReportStatisticsModel() override;
+
+	enum class Columns {
+		Type = 0,
+		Total,
+		FirstSeason, // one column for each season, oldest first
+	};
+
+	int rowCount(const QModelIndex &parent) const override;
+	int columnCount(const QModelIndex &parent) const override;
+	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+	void add(int type, DF::time time, int count);
+	// Signal the counts changed since the last flush, seasons without
+	// reports left are removed (types keep their rows).
+	void flush();
+	// Remove every count (for replacing them all, without signaling each
+	// new type and season)
+	void beginReset();
+	void endReset();
+
+private:
+	int row(int type);
+	int column(int season);
+
+	const AnnouncementTypeList &_type_list;
+	QList<int> _row_types; // type id of each row
+	QList<int> _type_rows; // row of each type id, or -1
+	QList<int> _seasons; // sorted season of each column
+	QList<QList<int>> _counts; // [row][season column]
+	QList<int> _type_totals;
+	QList<int> _season_totals;
+	bool _resetting;
+	// Cells changed since the last flush, as a bounding box
+	int _first_changed_row, _last_changed_row, _last_changed_season;
+};
+
+#endif
@@ -92,6 +92,17 @@ struct Settings
 
 	SettingProperty<bool> autorefresh_enabled = {"autorefresh/enabled", true};
 	SettingProperty<double> autorefresh_interval = {"autorefresh/interval", 2.0};
+	SettingProperty<bool> autorefresh_adaptive = {"autorefresh/adaptive", true};
+	SettingProperty<double> autorefresh_min_interval = {"autorefresh/min_interval", 0.5};
+	SettingProperty<double> autorefresh_max_interval = {"autorefresh/max_interval", 15.0};
+
+	// History limits (0 for unlimited)
+	SettingProperty<bool> history_keep_removed = {"history/keep_removed", false};
+	SettingProperty<int> history_max_rows = {"history/max_rows", 0};
+	SettingProperty<int> history_max_size = {"history/max_size", 0}; // in MiB
+	SettingProperty<int> history_max_years = {"history/max_years", 0};
+	SettingProperty<bool> history_archive = {"history/archive", false};
+	SettingProperty<QString> history_archive_name = {"history/archive_name", {}};
 
 	ColorPaletteModel color_palette;
 	AnnouncementTypeList announcement_types;
@@ -77,6 +77,17 @@ void SettingsDialog::loadSettings()
 	_ui->check_autorefresh->setChecked(settings->autorefresh_enabled());
 	_ui->spin_autorefresh_rate->setEnabled(settings->autorefresh_enabled());
 	_ui->spin_autorefresh_rate->setValue(settings->autorefresh_interval());
+	_ui->check_autorefresh_adaptive->setChecked(settings->autorefresh_adaptive());
+	_ui->spin_autorefresh_min_interval->setEnabled(settings->autorefresh_adaptive());
+	_ui->spin_autorefresh_min_interval->setValue(settings->autorefresh_min_interval());
+	_ui->spin_autorefresh_max_interval->setEnabled(settings->autorefresh_adaptive());
+	_ui->spin_autorefresh_max_interval->setValue(settings->autorefresh_max_interval());
+
+	_ui->check_history_keep_removed->setChecked(settings->history_keep_removed());
+	_ui->spin_history_max_rows->setValue(settings->history_max_rows());
+	_ui->spin_history_max_size->setValue(settings->history_max_size());
+	_ui->spin_history_max_years->setValue(settings->history_max_years());
+	_ui->check_history_archive->setChecked(settings->history_archive());
 
 	_ui->colors_view->setModel(&settings->color_palette);
 }
@@ -93,6 +104,17 @@ void SettingsDialog::saveSettings() const
 
 	settings->autorefresh_enabled = _ui->check_autorefresh->isChecked();
 	settings->autorefresh_interval = _ui->spin_autorefresh_rate->value();
+	settings->autorefresh_adaptive = _ui->check_autorefresh_adaptive->isChecked();
+	auto min_interval = _ui->spin_autorefresh_min_interval->value();
+	auto max_interval = _ui->spin_autorefresh_max_interval->value();
+	settings->autorefresh_min_interval = std::min(min_interval, max_interval);
+	settings->autorefresh_max_interval = std::max(min_interval, max_interval);
+
+	settings->history_keep_removed = _ui->check_history_keep_removed->isChecked();
+	settings->history_max_rows = _ui->spin_history_max_rows->value();
+	settings->history_max_size = _ui->spin_history_max_size->value();
+	settings->history_max_years = _ui->spin_history_max_years->value();
+	settings->history_archive = _ui->check_history_archive->isChecked();
 
 	settings->color_palette.save();
 }
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SubstringMatcher.h"
+
+#include <bit>
+#include <optional>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Every character that case-insensitively matches ASCII character c, or
+// an empty optional if c is not ASCII.
+static std::optional<std::array<char16_t, 3>> caseVariants(QChar c)
+{
+	auto u = c.unicode();
+	if (u >= 0x80)
+		return std::nullopt;
+	char16_t lower = QChar::toLower(u), upper = QChar::toUpper(u);
+	// Non-ASCII characters folding to ASCII letters
+	char16_t other = lower == u'k' ? u'\u212a' // Kelvin sign
+		: lower == u's' ? u'\u017f' // long s
+		: lower;
+	return std::array{lower, upper, other};
+}
+
+SubstringMatcher::SubstringMatcher(const QString &needle):
+	_needle(needle),
+	_first{},
+	_last{},
+	_simd(false)
+{
+	if (_needle.isEmpty())
+		return;
+	auto first = caseVariants(_needle.front());
+	auto last = caseVariants(_needle.back());
+	if (first && last) {
+		_first = *first;
+		_last = *last;
+		_simd = true;
+	}
+}
+
+bool SubstringMatcher::matches(QStringView text) const
+{
+	qsizetype n = _needle.size();
+	if (n == 0)
+		return true;
+	if (text.size() < n)
+		return false;
+	qsizetype i = 0;
+#ifdef __SSE2__
+	if (_simd) {
+		auto data = text.utf16();
+		auto set1 = [](char16_t c) { return _mm_set1_epi16(static_cast<short>(c)); };
+		const __m128i first0 = set1(_first[0]), first1 = set1(_first[1]), first2 = set1(_first[2]);
+		const __m128i last0 = set1(_last[0]), last1 = set1(_last[1]), last2 = set1(_last[2]);
+		for (; i + n - 1 + 8 <= text.size(); i += 8) {
+			auto a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+			auto b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + n - 1));
+			auto eq_first = _mm_or_si128(_mm_or_si128(
+					_mm_cmpeq_epi16(a, first0),
+					_mm_cmpeq_epi16(a, first1)),
+					_mm_cmpeq_epi16(a, first2));
+			auto eq_last = _mm_or_si128(_mm_or_si128(
+					_mm_cmpeq_epi16(b, last0),
+					_mm_cmpeq_epi16(b, last1)),
+					_mm_cmpeq_epi16(b, last2));
+			// Two mask bits for each 16-bit character
+			unsigned mask = _mm_movemask_epi8(_mm_and_si128(eq_first, eq_last));
+			while (mask) {
+				auto pos = i + std::countr_zero(mask) / 2;
+				if (text.sliced(pos, n).compare(_needle, Qt::CaseInsensitive) == 0)
+					return true;
+				mask &= mask - 1;
+				mask &= mask - 1;
+			}
+		}
+	}
+#endif
+	return text.sliced(i).contains(_needle, Qt::CaseInsensitive);
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SUBSTRING_MATCHER_H
+#define SUBSTRING_MATCHER_H
+
+#include <QString>
+
+#include <array>
+
+// Case-insensitive substring search. Positions where both the first and
+// the last characters of the needle match are found with SSE2 (eight
+// characters at a time), only those are compared with the needle.
+// Needles starting or ending with a non-ASCII character use
+// QStringView::contains.
+class SubstringMatcher
+{
+public:
+	SubstringMatcher(const QString &needle);
+
+	bool matches(QStringView text) const;
+
+private:
+	QString _needle;
+	// Characters folding to the first and last characters of the needle
+	std::array<char16_t, 3> _first, _last;
+	bool _simd;
+};
+
+#endif
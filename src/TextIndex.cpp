@@ -0,0 +1,153 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TextIndex.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <ranges>
+
+TextIndex::TextIndex():
+	_entries(0),
+	_removed_entries(0),
+	_generation(0),
+	_last_id(std::numeric_limits<int>::min())
+{
+}
+
+static void appendTrigrams(QStringView text, std::vector<TextIndex::Trigram> &trigrams)
+{
+	TextIndex::Trigram trigram = 0;
+	for (qsizetype i = 0; i < text.size(); ++i) {
+		trigram = (trigram << 16 | text[i].toCaseFolded().unicode()) & 0xffff'ffff'ffffull;
+		if (i >= 2)
+			trigrams.push_back(trigram);
+	}
+}
+
+static void sortUnique(std::vector<TextIndex::Trigram> &trigrams)
+{
+	std::ranges::sort(trigrams);
+	auto [first, last] = std::ranges::unique(trigrams);
+	trigrams.erase(first, last);
+}
+
+std::vector<TextIndex::Trigram> TextIndex::trigrams(QStringView text)
+{
+	std::vector<Trigram> trigrams;
+	appendTrigrams(text, trigrams);
+	sortUnique(trigrams);
+	return trigrams;
+}
+
+std::vector<TextIndex::Trigram> TextIndex::wildcardTrigrams(QStringView pattern)
+{
+	// Only literal runs are used, wildcards, character sets and escapes
+	// split them.
+	std::vector<Trigram> trigrams;
+	qsizetype begin = 0;
+	bool in_set = false;
+	for (qsizetype i = 0; i <= pattern.size(); ++i) {
+		auto c = i < pattern.size() ? pattern[i] : QChar();
+		if (in_set) {
+			if (c == u']') {
+				in_set = false;
+				begin = i+1;
+			}
+			continue;
+		}
+		if (i == pattern.size() || c == u'*' || c == u'?' || c == u'[' || c == u'\\') {
+			appendTrigrams(pattern.sliced(begin, i - begin), trigrams);
+			in_set = c == u'[';
+			begin = i+1;
+		}
+	}
+	sortUnique(trigrams);
+	return trigrams;
+}
+
+void TextIndex::insert(int id, const std::vector<Trigram> &trigrams)
+{
+	for (auto trigram: trigrams) {
+		auto &ids = _postings[trigram];
+		if (ids.empty() || ids.back() < id)
+			ids.push_back(id);
+		else
+			ids.insert(std::ranges::lower_bound(ids, id), id);
+		++_entries;
+	}
+	if (id <= _last_id)
+		++_generation;
+	else
+		_last_id = id;
+}
+
+void TextIndex::remove(qsizetype entries)
+{
+	_removed_entries += entries;
+}
+
+void TextIndex::clear()
+{
+	_postings.clear();
+	_entries = 0;
+	_removed_entries = 0;
+	_last_id = std::numeric_limits<int>::min();
+	++_generation;
+}
+
+void TextIndex::compact(const QList<int> &ids)
+{
+	if (_removed_entries < _entries / 2)
+		return;
+	for (auto it = _postings.begin(); it != _postings.end();) {
+		std::erase_if(*it, [&ids](int id) {
+				return !std::binary_search(ids.begin(), ids.end(), id);
+			});
+		if (it->empty())
+			it = _postings.erase(it);
+		else
+			++it;
+	}
+	_entries -= _removed_entries;
+	_removed_entries = 0;
+}
+
+std::vector<int> TextIndex::candidates(const std::vector<Trigram> &trigrams) const
+{
+	Q_ASSERT(!trigrams.empty());
+	// Intersect from the shortest list so the result shrinks quickly
+	std::vector<const std::vector<int> *> lists;
+	for (auto trigram: trigrams) {
+		auto it = _postings.constFind(trigram);
+		if (it == _postings.constEnd())
+			return {};
+		lists.push_back(&*it);
+	}
+	std::ranges::sort(lists, std::less<>{}, &std::vector<int>::size);
+	std::vector<int> result = *lists.front(), tmp;
+	for (auto list: lists | std::views::drop(1)) {
+		tmp.clear();
+		std::ranges::set_intersection(result, *list, std::back_inserter(tmp));
+		std::swap(result, tmp);
+		if (result.empty())
+			break;
+	}
+	return result;
+}
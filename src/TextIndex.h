@@ -0,0 +1,69 @@
+/*
+ * Copyright 2023 Clement Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TEXT_INDEX_H
+#define TEXT_INDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QStringView>
+
+#include <vector>
+
+// Trigram index of report texts: for each case-folded trigram, the sorted
+// list of ids of the reports containing it. Substring queries become
+// intersections of these lists, the candidates still need to be matched.
+class TextIndex
+{
+public:
+	using Trigram = quint64;
+
+	TextIndex();
+
+	// Case-folded trigrams in text, sorted without duplicates
+	static std::vector<Trigram> trigrams(QStringView text);
+	// Trigrams that any text matching the wildcard pattern must contain
+	static std::vector<Trigram> wildcardTrigrams(QStringView pattern);
+
+	// trigrams are from trigrams(), they can be computed beforehand in
+	// another thread
+	void insert(int id, const std::vector<Trigram> &trigrams);
+	// Removed ids are only counted (with the number of trigrams they were
+	// inserted with), compact() drops them from the lists
+	void remove(qsizetype entries);
+	void clear();
+	// Drop ids absent from the sorted ids list when enough were removed
+	void compact(const QList<int> &ids);
+
+	// Incremented when ids are inserted before the last one, candidates
+	// computed from an older generation may miss some of them.
+	quint64 generation() const { return _generation; }
+	int lastId() const { return _last_id; }
+
+	// Sorted ids of reports containing all the trigrams, may include
+	// removed ids. trigrams must not be empty.
+	std::vector<int> candidates(const std::vector<Trigram> &trigrams) const;
+
+private:
+	QHash<Trigram, std::vector<int>> _postings;
+	qsizetype _entries, _removed_entries;
+	quint64 _generation;
+	int _last_id;
+};
+
+#endif